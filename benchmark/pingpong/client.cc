@@ -13,6 +13,9 @@ using namespace nc;
 int conn_nums = 0;
 const int mesg_sz = 16*1024; 
 
+// IO后端
+net::backend_t engine = net::backend::epoll;
+
 // 线程通知机制
 int thr_nums = 0;
 int thr_done_nums = 0;
@@ -32,7 +35,7 @@ double get_absolute_time() {
 }
 
 void mesg_sender () {
-    net::reactor rec;
+    net::reactor rec(-1, engine);
     std::vector<net::tcp_clnt_socket> socks(conn_nums); // 防止直接析构关闭了套接字
     int connected = 0;
 
@@ -91,13 +94,14 @@ void mesg_sender () {
 
 int main(int argn, char** args) {
 
-    assert(argn == 3);
+    assert(argn >= 3);
     thr_nums = atoi(args[1]);   // 线程数
     conn_nums = atoi(args[2]);   // 每条线程的连接数
+    if (argn > 3 && !strcmp(args[3], "uring")) {
+        engine = net::backend::uring;  // 可选: io_uring后端
+    }
 
-    int fd = net::signal_socket_init();   // 初始化信号机制以屏蔽SIGPIPE
-    net::signal_add(SIGPIPE);
-    // 当信号传来时我们忽略它(不处理fd即可)
+    net::signal_ignore(SIGPIPE);   // 忽略SIGPIPE
 
     std::vector<std::thread> threadpool;
     for (int i = 0; i < thr_nums; ++i) {
@@ -7,8 +7,10 @@ using namespace nc;
 
 const int mesg_sz = 16*1024; 
 
-int main() {
-    net::reactor rec;
+// 用法: ./server [uring]
+int main(int argn, char** args) {
+    net::backend_t engine = (argn > 1 && !strcmp(args[1], "uring")) ? net::backend::uring : net::backend::epoll;
+    net::reactor rec(-1, engine);
     net::tcp_serv_socket serv_sock;
 
     net::set_nonblocking(serv_sock.get_fd());
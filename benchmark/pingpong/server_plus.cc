@@ -3,30 +3,40 @@
 #include <iostream>
 using namespace nc;
 
+// 用法: ./server_plus <节点数> [uring]
 int main(int argn, char** args) {
-    assert(argn == 2);
+    assert(argn >= 2);
+    net::backend_t engine = (argn > 2 && !strcmp(args[2], "uring")) ? net::backend::uring : net::backend::epoll;
     net::tcp_serv_socket sock;
     net::set_reuse_address(sock.get_fd());
     net::set_tcp_nondelay(sock.get_fd());
     sock.listen_req("127.0.0.1", 9090);
 
-    net::creactors recs;
+    net::creactors recs(engine);
     recs.bind_serv_socket(std::move(sock));
     recs.init_async_nodes(atoi(args[1]));  // 初始化异步工作节点
 
+    int mesg_sz = 16*1024;
+    for (int i = 0; i < atoi(args[1]); ++i) {
+        recs[i]->set_read_budget(4 * mesg_sz);  // 每次可读事件最多读取4条消息
+    }
+
     // 统一设置工作节点 
     recs.set_connect_cb([](net::reactor* rec, int fd){
-        net::set_nonblocking(fd);
-        rec->add_socket(fd, net::event::readable, net::pattern::lt);
+        rec->add_socket(fd, net::event::readable, net::pattern::et);
     });
 
-    int mesg_sz = 16*1024;
     char buffer[mesg_sz];
-    recs.set_readable_cb([&buffer, &mesg_sz](net::reactor* , int fd){
+    recs.set_readable_cb([&buffer, &mesg_sz](net::reactor* rec, int fd){
+        size_t budget = rec->get_read_budget();
+        size_t recv_bytes = 0;
         int tmp = 0;
-        int recv_bytes = 0;
-        while ((tmp = recv(fd, buffer, mesg_sz-recv_bytes, 0)) > 0) { // 读取16k
+        while ((tmp = recv(fd, buffer, mesg_sz, 0)) > 0) { // 每次读取16k
             recv_bytes += tmp;
+            if (budget && recv_bytes >= budget) {  // 读满预算后让出，未读完的数据由就绪列表在下一轮继续读取
+                rec->requeue(fd);
+                break;
+            }
         } 
     });
     recs.activate();
@@ -1,4 +1,7 @@
 #!/bin/bash
 
 g++ -std=c++11 -O3 -Wall -Werror -I ../../include client.cc ../../src/signal.cc -lpthread -o client
-g++ -std=c++11 -O3 -Wall -Werror -I ../../include server.cc ../../src/signal.cc -lpthread -o server
\ No newline at end of file
+g++ -std=c++11 -O3 -Wall -Werror -I ../../include server.cc ../../src/signal.cc -lpthread -o server
+g++ -std=c++11 -O3 -Wall -Werror -I ../../include server_conn.cc ../../src/signal.cc -lpthread -o server_conn
+g++ -std=c++20 -O3 -Wall -Werror -I ../../include server_co.cc ../../src/signal.cc -lpthread -o server_co
+g++ -std=c++11 -O3 -Wall -Werror -I ../../include conn_rate.cc ../../src/signal.cc -lpthread -o conn_rate
@@ -15,6 +15,9 @@ using namespace nc;
 // 连接数
 int conn_nums = 0;
 
+// IO后端
+net::backend_t engine = net::backend::epoll;
+
 // 线程通知机制
 int thr_nums = 0;
 int thr_done_nums = 0;
@@ -35,17 +38,16 @@ double get_absolute_time() {
 }
 
 void mesg_sender () {
-    net::reactor rec;
+    net::reactor rec(-1, engine);
     std::vector<net::tcp_clnt_socket> socks(conn_nums); // 防止直接析构关闭了套接字
     int connected = 0;
 
     for (int i = 0; i < conn_nums; ++i) {
         int fd = socks[i].get_fd();
         assert(net::get_send_bufsz(fd) >= SEND_BYTES); // 避免缓冲区过小影响测量结果
-        socks[i].launch_req("127.0.0.1", 9090);  
-        net::set_nonblocking(fd);  // 非阻塞IO
+        socks[i].launch_async_req("127.0.0.1", 9090);  // 非阻塞连接，不必逐个等待握手
         connected++;
-        rec.add_socket(fd, net::event::writable, net::pattern::et_oneshot);
+        rec.add_socket(fd, net::event::writable, net::pattern::et_oneshot);  // 连接完成后可写
     }
     {
         std::lock_guard<std::mutex> lock(out_lok);
@@ -126,13 +128,14 @@ void mesg_sender () {
 
 int main(int argn, char** args) {
 
-    assert(argn == 3);
+    assert(argn >= 3);
     thr_nums = atoi(args[1]);    // 线程数
     conn_nums = atoi(args[2]);   // 每条线程的连接数
+    if (argn > 3 && !strcmp(args[3], "uring")) {
+        engine = net::backend::uring;  // 可选: io_uring后端
+    }
 
-    net::signal_socket_init();   // 初始化信号机制以屏蔽SIGPIPE
-    net::signal_add(SIGPIPE);
-    // 当信号传来时我们忽略它(不处理fd即可)
+    net::signal_ignore(SIGPIPE);   // 忽略SIGPIPE
 
     std::vector<std::thread> threadpool;
     for (int i = 0; i < thr_nums; ++i) {
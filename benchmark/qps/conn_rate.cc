@@ -0,0 +1,66 @@
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "nancy/net/creactors.h"
+using namespace nc;
+
+// 连接建立速率：客户端线程反复 连接->发送1字节->读取应答->关闭，统计每秒完成的连接数
+// 用法: ./conn_rate <节点数> <客户端线程数> [reuseport] [uring]
+int main(int argn, char** args) {
+    assert(argn >= 3);
+    int node_nums = atoi(args[1]);
+    int thr_nums = atoi(args[2]);
+    bool reuseport = false;
+    net::backend_t engine = net::backend::epoll;
+    for (int i = 3; i < argn; ++i) {
+        reuseport = reuseport || !strcmp(args[i], "reuseport");
+        engine = !strcmp(args[i], "uring") ? net::backend::uring : engine;
+    }
+
+    net::creactors recs(engine);
+    if (reuseport) {
+        recs.bind_reuseport("127.0.0.1", 9090);
+    } else {
+        net::tcp_serv_socket sok;
+        net::set_reuse_address(sok.get_fd());
+        sok.listen_req("127.0.0.1", 9090);
+        recs.bind_serv_socket(std::move(sok));
+    }
+    recs.init_async_nodes(node_nums);
+    recs.set_message_cb([](net::reactor* rec, net::connection* conn) {
+        rec->send(conn, "y", 1);
+        conn->input()->retrieve_all();
+    });
+
+    const auto duration = std::chrono::seconds(3);
+    std::atomic<long> completed = {0};
+    std::thread clients([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        std::vector<std::thread> threads;
+        auto deadline = std::chrono::steady_clock::now() + duration;
+        for (int i = 0; i < thr_nums; ++i) {
+            threads.emplace_back([&] {
+                struct linger lg = {1, 0};  // 以RST关闭，避免客户端端口耗尽在TIME_WAIT中
+                char c;
+                while (std::chrono::steady_clock::now() < deadline) {
+                    net::tcp_clnt_socket clnt;
+                    setsockopt(clnt.get_fd(), SOL_SOCKET, SO_LINGER, &lg, sizeof(lg));
+                    clnt.launch_req("127.0.0.1", 9090);
+                    if (write(clnt.get_fd(), "x", 1) == 1 && read(clnt.get_fd(), &c, 1) == 1) {
+                        ++completed;
+                    }
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        recs.root()->post([&recs] { recs.root()->destroy(); });
+    });
+    recs.activate();
+    clients.join();
+    std::cout << "Mode: " << (reuseport ? "reuseport" : "root acceptor") << std::endl;
+    std::cout << "Connections per second: " << completed / duration.count() << std::endl;
+}
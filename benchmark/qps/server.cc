@@ -4,8 +4,10 @@ using namespace nc;
 #define RECV_BYTES 4096
 #define SEND_BYTES 16384
 
+// 用法: ./server <节点数> [uring]
 int main(int argn, char** args) {
-    assert(argn == 2);
+    assert(argn >= 2);
+    net::backend_t engine = (argn > 2 && !strcmp(args[2], "uring")) ? net::backend::uring : net::backend::epoll;
 
     // sock
     net::tcp_serv_socket sok;
@@ -13,12 +15,11 @@ int main(int argn, char** args) {
     sok.listen_req("127.0.0.1", 9090);
 
     // concurrent reactors
-    net::creactors recs;
+    net::creactors recs(engine);
     recs.bind_serv_socket(std::move(sok));
     recs.init_async_nodes(atoi(args[1]));
 
     recs.set_connect_cb([](net::reactor* rec, int fd){
-        net::set_nonblocking(fd);
         rec->add_socket(fd, net::event::readable, net::pattern::et); 
     });
 
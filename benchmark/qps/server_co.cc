@@ -0,0 +1,52 @@
+#include "nancy/net/creactors.h"
+#include "nancy/net/coroutine.h"
+using namespace nc;
+
+#define RECV_BYTES 4096
+#define SEND_BYTES 16384
+
+// 与server.cc相同的请求/响应模式，每个连接由一个协程处理（需要C++20）
+// 用法: ./server_co <节点数> [uring]
+
+static char mesg[SEND_BYTES];  // 16k
+
+net::co::task session(net::reactor* rec, int fd) {
+    char buf[RECV_BYTES];
+    for (;;) {
+        // 读满4k请求
+        size_t idx = 0;
+        ssize_t bytes = 0;
+        while (idx < RECV_BYTES && (bytes = co_await net::co::async_read(*rec, fd, buf + idx, RECV_BYTES - idx)) > 0) {
+            idx += bytes;
+        }
+        if (idx < RECV_BYTES) {
+            break;
+        }
+        // 返回16k响应
+        if (co_await net::co::async_write(*rec, fd, mesg, SEND_BYTES) != SEND_BYTES) {
+            break;
+        }
+    }
+    net::co::close(*rec, fd);
+}
+
+int main(int argn, char** args) {
+    assert(argn >= 2);
+    net::backend_t engine = (argn > 2 && !strcmp(args[2], "uring")) ? net::backend::uring : net::backend::epoll;
+    memset(mesg, 'x', SEND_BYTES);
+    mesg[16383] = 'y';
+
+    // sock
+    net::tcp_serv_socket sok;
+    net::set_reuse_address(sok.get_fd());
+    sok.listen_req("127.0.0.1", 9090);
+
+    // concurrent reactors
+    net::creactors recs(engine);
+    recs.bind_serv_socket(std::move(sok));
+    recs.init_async_nodes(atoi(args[1]));
+    recs.set_connect_cb([](net::reactor* rec, int fd) {
+        session(rec, fd);
+    });
+    recs.activate();
+}
@@ -0,0 +1,47 @@
+#include "nancy/net/creactors.h"
+using namespace nc;
+
+#define RECV_BYTES 4096
+#define SEND_BYTES 16384
+
+// 与server.cc相同的请求/响应模式，由connection管理读写缓冲区
+// 用法: ./server_conn <节点数> [uring] [zerocopy] [reuseport]
+int main(int argn, char** args) {
+    assert(argn >= 2);
+    net::backend_t engine = net::backend::epoll;
+    bool zerocopy = false;  // 以MSG_ZEROCOPY发送16k响应（回环地址上内核会退化为复制）
+    bool reuseport = false;  // 各节点以SO_REUSEPORT独立监听
+    for (int i = 2; i < argn; ++i) {
+        engine = !strcmp(args[i], "uring") ? net::backend::uring : engine;
+        zerocopy = zerocopy || !strcmp(args[i], "zerocopy");
+        reuseport = reuseport || !strcmp(args[i], "reuseport");
+    }
+
+    // concurrent reactors
+    net::creactors recs(engine);
+    if (reuseport) {
+        recs.bind_reuseport("127.0.0.1", 9090);
+    } else {
+        net::tcp_serv_socket sok;
+        net::set_reuse_address(sok.get_fd());
+        sok.listen_req("127.0.0.1", 9090);
+        recs.bind_serv_socket(std::move(sok));
+    }
+    recs.init_async_nodes(atoi(args[1]));
+
+    char mesg[SEND_BYTES];  // 16k
+    memset(mesg, 'x', SEND_BYTES);
+    mesg[16383] = 'y';
+    recs.set_message_cb([&](net::reactor* rec, net::connection* conn) {
+        auto* in = conn->input();
+        while (in->readable_bytes() >= RECV_BYTES) {
+            in->retrieve(RECV_BYTES);
+            if (zerocopy) {
+                rec->send_zerocopy(conn, mesg, SEND_BYTES, []{});  // 响应为静态数据，无需释放
+            } else {
+                rec->send(conn, mesg, SEND_BYTES);
+            }
+        }
+    });
+    recs.activate();
+}
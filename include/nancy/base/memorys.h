@@ -1,5 +1,6 @@
 #pragma once
 #include <vector>
+#include <array>
 #include <map>
 #include <unordered_map>
 #include <cstdint>
@@ -0,0 +1,191 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <utility>
+
+namespace nc::details {
+
+/**
+ * @brief 无锁多生产者单消费者队列(MPSC)，基于侵入式链表实现
+ * @note  push可在任意线程调用，pop/drain只能由唯一的消费者线程调用
+ * @note  push只有一次原子交换，不会阻塞生产者
+ */
+template <typename T>
+class mpsc_queue {
+    struct node {
+        std::atomic<node*> next = {nullptr};
+        T value = {};
+        node() = default;
+        explicit node(T&& v) : value(std::move(v)) {}
+    };
+
+    std::atomic<node*> head;  // 生产者插入端
+    node* tail;               // 消费者取出端，始终指向一个哨兵节点
+
+public:
+    mpsc_queue() {
+        node* stub = new node();
+        head.store(stub, std::memory_order_relaxed);
+        tail = stub;
+    }
+    mpsc_queue(const mpsc_queue&) = delete;
+    mpsc_queue& operator=(const mpsc_queue&) = delete;
+    ~mpsc_queue() {
+        T tmp;
+        while (pop(tmp)) {}
+        delete tail;
+    }
+
+public:
+    // 插入元素，线程安全
+    void push(T value) {
+        node* n = new node(std::move(value));
+        node* prev = head.exchange(n, std::memory_order_acq_rel);
+        prev->next.store(n, std::memory_order_release);
+    }
+
+    /**
+     * @brief 取出一个元素
+     * @return 队列为空时返回false
+     * @note 生产者正在插入时会短暂自旋等待其完成链接
+     */
+    bool pop(T& out) {
+        node* t = tail;
+        node* next = t->next.load(std::memory_order_acquire);
+        if (next == nullptr) {
+            if (head.load(std::memory_order_acquire) == t) {
+                return false;
+            }
+            while ((next = t->next.load(std::memory_order_acquire)) == nullptr) {
+                std::this_thread::yield();
+            }
+        }
+        out = std::move(next->value);
+        tail = next;
+        delete t;
+        return true;
+    }
+
+    /**
+     * @brief 取出调用时刻之前插入的所有元素，之后插入的留待下一次
+     * @param f 处理元素的可执行对象
+     * @return 处理的元素个数
+     */
+    template <typename F>
+    size_t drain(F&& f) {
+        node* last = head.load(std::memory_order_acquire);
+        size_t n = 0;
+        T tmp;
+        while (tail != last && pop(tmp)) {
+            f(tmp);
+            ++n;
+        }
+        return n;
+    }
+
+    // 近似判断队列是否为空，仅供消费者使用
+    bool empty() const {
+        return tail->next.load(std::memory_order_acquire) == nullptr &&
+               head.load(std::memory_order_acquire) == tail;
+    }
+};
+
+/**
+ * @brief 有界无锁单生产者单消费者队列(SPSC)，基于环形数组实现
+ * @note  push只能由唯一的生产者线程调用，pop/drain只能由唯一的消费者线程调用
+ * @note  生产者与消费者的位置分处不同的缓存行，并各自缓存对方的位置，队列未满/非空时不读取对方写入的变量
+ */
+template <typename T>
+class spsc_queue {
+    static const size_t cacheline = 64;
+
+    // 以整条缓存行填充分隔双方频繁写入的变量，不依赖对象的对齐(C++11的new不保证扩展对齐)
+    const size_t mask;
+    std::unique_ptr<T[]> slots;
+    char pad0[cacheline];
+    std::atomic<size_t> head = {0};  // 消费者取出位置
+    size_t cached_tail = 0;          // 消费者所见的生产者位置
+    char pad1[cacheline];
+    std::atomic<size_t> tail = {0};  // 生产者写入位置
+    size_t cached_head = 0;          // 生产者所见的消费者位置
+    char pad2[cacheline];
+
+public:
+    /**
+     * @param capacity 容量，向上取整为2的幂
+     */
+    explicit spsc_queue(size_t capacity)
+        : mask(round_up(capacity) - 1)
+        , slots(new T[mask + 1]) {}
+    spsc_queue(const spsc_queue&) = delete;
+    spsc_queue& operator=(const spsc_queue&) = delete;
+    ~spsc_queue() = default;
+
+public:
+    /**
+     * @brief 插入元素，仅生产者调用
+     * @return 队列已满时返回false
+     */
+    bool push(T value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - cached_head > mask) {
+            cached_head = head.load(std::memory_order_acquire);
+            if (t - cached_head > mask) {
+                return false;
+            }
+        }
+        slots[t & mask] = std::move(value);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 取出一个元素，仅消费者调用
+     * @return 队列为空时返回false
+     */
+    bool pop(T& out) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == cached_tail) {
+            cached_tail = tail.load(std::memory_order_acquire);
+            if (h == cached_tail) {
+                return false;
+            }
+        }
+        out = std::move(slots[h & mask]);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 取出队列中的所有元素
+     * @param f 处理元素的可执行对象
+     * @return 处理的元素个数
+     */
+    template <typename F>
+    size_t drain(F&& f) {
+        size_t n = 0;
+        T tmp;
+        while (pop(tmp)) {
+            f(tmp);
+            ++n;
+        }
+        return n;
+    }
+
+    size_t capacity() const noexcept {
+        return mask + 1;
+    }
+
+private:
+    static size_t round_up(size_t n) {
+        size_t cap = 1;
+        while (cap < n) {
+            cap <<= 1;
+        }
+        return cap;
+    }
+};
+
+}  // namespace nc::details
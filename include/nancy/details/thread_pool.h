@@ -0,0 +1,154 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace nc::details {
+
+/**
+ * @brief 工作窃取线程池，用于执行计算密集的任务
+ * @note  每个工作线程拥有自己的任务队列：外部线程提交的任务轮流放入各队列，工作线程提交的任务放入自己的队列；
+ *        工作线程从自己队列的尾部取任务(后进先出，缓存更热)，为空时从其它队列的头部窃取
+ * @note  每个队列各自加锁，提交与取出只竞争同一个队列；只有存在空闲线程时提交方才加锁唤醒
+ * @note  submit线程安全；析构时执行完已提交的任务后退出
+ */
+class work_stealing_pool {
+    using task_t = std::function<void()>;
+
+    struct worker_queue {
+        std::mutex mtx;
+        std::deque<task_t> tasks;
+        char pad[64];  // 避免相邻队列的锁位于同一缓存行
+    };
+
+    std::vector<std::unique_ptr<worker_queue>> queues;
+    std::vector<std::thread> threads;
+    std::atomic<size_t> next = {0};     // 外部提交的轮询位置
+    std::atomic<size_t> pending = {0};  // 已提交且尚未被取出的任务数
+    std::atomic<size_t> idle = {0};     // 等待中的工作线程数
+    std::mutex sleep_mtx;
+    std::condition_variable sleep_cv;
+    bool stop = false;
+
+public:
+    /**
+     * @param nums 工作线程数，0为硬件线程数
+     */
+    explicit work_stealing_pool(size_t nums = 0) {
+        if (nums == 0) {
+            nums = std::thread::hardware_concurrency();
+            nums = nums ? nums : 1;
+        }
+        for (size_t i = 0; i < nums; ++i) {
+            queues.emplace_back(new worker_queue());
+        }
+        for (size_t i = 0; i < nums; ++i) {
+            threads.emplace_back(&work_stealing_pool::worker, this, i);
+        }
+    }
+    work_stealing_pool(const work_stealing_pool&) = delete;
+    work_stealing_pool& operator=(const work_stealing_pool&) = delete;
+    ~work_stealing_pool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mtx);
+            stop = true;
+        }
+        sleep_cv.notify_all();
+        for (auto& t : threads) {
+            t.join();
+        }
+    }
+
+public:
+    /**
+     * @brief 提交任务
+     * @param task 任务，不应抛出异常
+     */
+    template <typename F>
+    void submit(F&& task) {
+        size_t idx = self() == this ? self_index() : next.fetch_add(1, std::memory_order_relaxed) % queues.size();
+        pending.fetch_add(1);  // 先于入队，取出方的递减不会使其回绕
+        {
+            std::lock_guard<std::mutex> lock(queues[idx]->mtx);
+            queues[idx]->tasks.emplace_back(std::forward<F>(task));
+        }
+        if (idle.load() > 0) {  // 与工作线程的idle递增、pending检查构成seq_cst的配对，不会丢失唤醒
+            std::lock_guard<std::mutex> lock(sleep_mtx);
+            sleep_cv.notify_one();
+        }
+    }
+
+    // 工作线程数
+    size_t size() const noexcept {
+        return threads.size();
+    }
+
+    // 已提交且尚未开始执行的任务数，仅供参考
+    size_t backlog() const noexcept {
+        return pending.load(std::memory_order_relaxed);
+    }
+
+private:
+    // 当前线程所属的线程池及其下标，非工作线程为nullptr
+    static work_stealing_pool*& self() {
+        static thread_local work_stealing_pool* pool = nullptr;
+        return pool;
+    }
+
+    static size_t& self_index() {
+        static thread_local size_t idx = 0;
+        return idx;
+    }
+
+    // 从自己队列的尾部或其它队列的头部取出任务
+    bool take(size_t idx, task_t& task) {
+        {
+            auto& own = *queues[idx];
+            std::lock_guard<std::mutex> lock(own.mtx);
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+        for (size_t i = 1; i < queues.size(); ++i) {
+            auto& victim = *queues[(idx + i) % queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mtx);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void worker(size_t idx) {
+        self() = this;
+        self_index() = idx;
+        task_t task;
+        for (;;) {
+            if (take(idx, task)) {
+                pending.fetch_sub(1, std::memory_order_relaxed);
+                task();
+                task = nullptr;
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleep_mtx);
+            idle.fetch_add(1);
+            sleep_cv.wait(lock, [this] { return stop || pending.load() > 0; });
+            idle.fetch_sub(1);
+            if (stop && pending.load() == 0) {
+                return;
+            }
+        }
+    }
+};
+
+}  // namespace nc::details
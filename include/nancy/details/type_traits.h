@@ -7,4 +7,11 @@ namespace nc::details {
 template <typename F, typename... Args>
 using is_runnable = std::is_constructible<std::function<void(Args...)>, typename std::remove_reference<F>::type>;
 
+// 以Args...及类型为R的结果调用F，R为void时没有结果参数
+template <typename F, typename R, typename... Args>
+struct is_result_runnable : is_runnable<F, Args..., R> {};
+
+template <typename F, typename... Args>
+struct is_result_runnable<F, void, Args...> : is_runnable<F, Args...> {};
+
 } // namespace nc::net
@@ -0,0 +1,145 @@
+#pragma once
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <string>
+
+namespace nc::net {
+
+/**
+ * @brief 可增长的连接缓冲区
+ * @note  布局: [已读取(可回收) | 可读数据 | 可写空间]，空间不足时优先回收已读取部分，否则按倍数扩容
+ * @note  非线程安全
+ */
+class buffer {
+    std::unique_ptr<char[]> buf = {nullptr};
+    size_t cap = 0;
+    size_t ridx = 0;
+    size_t widx = 0;
+
+public:
+    static const size_t initial_size = 1024;
+    static const size_t extra_size = 65536;  // read_fd使用的栈上额外缓冲区
+
+    explicit buffer(size_t size = initial_size)
+        : buf(new char[size])
+        , cap(size) {}
+    buffer(buffer&&) = default;
+    buffer& operator=(buffer&&) = default;
+    buffer(const buffer&) = delete;
+    buffer& operator=(const buffer&) = delete;
+    ~buffer() = default;
+
+public:
+    // 可读字节数
+    size_t readable_bytes() const noexcept {
+        return widx - ridx;
+    }
+
+    // 可写字节数
+    size_t writable_bytes() const noexcept {
+        return cap - widx;
+    }
+
+    // 可读数据的起始地址
+    const char* peek() const noexcept {
+        return buf.get() + ridx;
+    }
+
+    // 可写空间的起始地址
+    char* begin_write() noexcept {
+        return buf.get() + widx;
+    }
+
+    // 向可写空间写入n字节后调用
+    void has_written(size_t n) noexcept {
+        assert(n <= writable_bytes());
+        widx += n;
+    }
+
+    // 消费n字节
+    void retrieve(size_t n) noexcept {
+        if (n < readable_bytes()) {
+            ridx += n;
+        } else {
+            retrieve_all();
+        }
+    }
+
+    // 消费全部数据
+    void retrieve_all() noexcept {
+        ridx = widx = 0;
+    }
+
+    // 消费n字节并以string返回
+    std::string retrieve_as_string(size_t n) {
+        n = n < readable_bytes() ? n : readable_bytes();
+        std::string res(peek(), n);
+        retrieve(n);
+        return res;
+    }
+
+    // 追加数据
+    void append(const char* data, size_t n) {
+        ensure_writable(n);
+        memcpy(begin_write(), data, n);
+        widx += n;
+    }
+
+    // 确保至少有n字节的可写空间
+    void ensure_writable(size_t n) {
+        if (writable_bytes() >= n) {
+            return;
+        }
+        size_t readable = readable_bytes();
+        if (ridx + writable_bytes() >= n && readable <= cap / 2) {
+            // 回收已读取部分即可
+            memmove(buf.get(), peek(), readable);
+        } else {
+            size_t new_cap = cap * 2;
+            while (new_cap - readable < n) {
+                new_cap *= 2;
+            }
+            std::unique_ptr<char[]> tmp(new char[new_cap]);
+            memcpy(tmp.get(), peek(), readable);
+            buf = std::move(tmp);
+            cap = new_cap;
+        }
+        ridx = 0;
+        widx = readable;
+    }
+
+    /**
+     * @brief 从fd读取数据到缓冲区
+     * @param fd 文件描述符
+     * @param saved_errno 失败时保存errno
+     * @return read的返回值
+     * @note 通过readv同时读入可写空间和栈上的额外缓冲区，一次系统调用即可读取较多数据，又不必预先分配大块内存
+     */
+    ssize_t read_fd(int fd, int* saved_errno) {
+        char extra[extra_size];
+        struct iovec vec[2];
+        const size_t writable = writable_bytes();
+        vec[0].iov_base = begin_write();
+        vec[0].iov_len = writable;
+        vec[1].iov_base = extra;
+        vec[1].iov_len = sizeof(extra);
+        const int iovcnt = (writable < sizeof(extra)) ? 2 : 1;
+        const ssize_t n = readv(fd, vec, iovcnt);
+        if (n < 0) {
+            *saved_errno = errno;
+        } else if (static_cast<size_t>(n) <= writable) {
+            widx += n;
+        } else {
+            widx = cap;
+            append(extra, n - writable);
+        }
+        return n;
+    }
+};
+
+}  // namespace nc::net
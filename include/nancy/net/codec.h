@@ -0,0 +1,279 @@
+#pragma once
+#include <sys/uio.h>
+#include <cstdint>
+#include <cstring>
+#include "nancy/net/reactor.h"
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+namespace nc::net {
+
+namespace _codec {
+
+// CRC32C(Castagnoli)的查表实现，按字节处理
+inline uint32_t crc32c_table(uint32_t crc, const char* data, size_t len) {
+    struct table_t {
+        uint32_t entries[256];
+        table_t() {
+            for (uint32_t i = 0; i < 256; ++i) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; ++k) {
+                    c = (c & 1) ? (c >> 1) ^ 0x82f63b78u : c >> 1;
+                }
+                entries[i] = c;
+            }
+        }
+    };
+    static const table_t table;
+    auto* p = reinterpret_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < len; ++i) {
+        crc = table.entries[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#if defined(__x86_64__)
+// SSE4.2的crc32指令，每次处理8字节；无需以-msse4.2编译，运行时检测后调用
+__attribute__((target("sse4.2"))) inline uint32_t crc32c_sse42(uint32_t crc, const char* data, size_t len) {
+    uint64_t c = crc;
+    for (; len >= 8; data += 8, len -= 8) {
+        uint64_t word;
+        memcpy(&word, data, 8);
+        c = _mm_crc32_u64(c, word);
+    }
+    uint32_t res = static_cast<uint32_t>(c);
+    for (; len; ++data, --len) {
+        res = _mm_crc32_u8(res, static_cast<unsigned char>(*data));
+    }
+    return res;
+}
+#endif
+
+}  // namespace _codec
+
+/**
+ * @brief 计算CRC32C校验和
+ * @param data 数据
+ * @param len 字节数
+ * @param crc 此前数据的校验和，用于分段计算
+ * @note CPU支持SSE4.2时使用crc32指令，否则查表
+ */
+inline uint32_t crc32c(const char* data, size_t len, uint32_t crc = 0) {
+#if defined(__x86_64__)
+    static const bool sse42 = __builtin_cpu_supports("sse4.2");
+    if (sse42) {
+        return ~_codec::crc32c_sse42(~crc, data, len);
+    }
+#endif
+    return ~_codec::crc32c_table(~crc, data, len);
+}
+
+// 指向输入缓冲区中一帧负载的视图，不复制数据，只在回调返回前有效
+struct frame_view {
+    const char* data;
+    size_t len;
+};
+
+/**
+ * @brief 长度前缀的二进制分帧: [长度][负载][CRC32C(负载)，可选]
+ * @note  长度为负载的字节数，格式见length_format；校验和为4字节网络字节序
+ * @note  解码一次遍历输入缓冲区中的全部完整帧，以视图交付后统一消费，一次读入的多个流水线帧不产生复制
+ * @note  无状态，可在多个连接、多个反应堆之间共用
+ */
+class frame_codec {
+    length_format_t format;
+    bool checksum;
+    size_t max_frame;
+
+public:
+    static const int max_header = 5;  // 长度前缀的最大字节数
+
+    /**
+     * @param format 长度前缀格式
+     * @param checksum 是否在负载后附加CRC32C并在解码时校验
+     * @param max_frame 允许的最大负载长度，fixed16格式下不超过65535
+     */
+    explicit frame_codec(length_format_t format = length_format::varint, bool checksum = false,
+                         size_t max_frame = config::max_frame_size)
+        : format(format)
+        , checksum(checksum)
+        , max_frame(format == length_format::fixed16 && max_frame > 0xffff ? 0xffff : max_frame) {}
+
+public:
+    /**
+     * @brief 解析缓冲区中的全部完整帧，并消费已解析的部分
+     * @param in 输入缓冲区
+     * @param cb 回调bool(frame_view)，返回false时停止解析，其后的数据留在缓冲区中
+     * @return 交付的帧数；长度超限、前缀格式错误或校验失败时返回-1，此前的帧已交付并消费
+     * @note 回调中不应消费或修改该缓冲区；不完整的帧留待下一次读入数据后继续
+     */
+    template <typename F>
+    int decode(buffer* in, F&& cb) {
+        const char* begin = in->peek();
+        size_t avail = in->readable_bytes();
+        size_t pos = 0;
+        int frames = 0;
+        bool error = false;
+        while (pos < avail) {
+            uint64_t len = 0;
+            int hdr = parse_header(begin + pos, avail - pos, &len);
+            if (hdr == 0) {  // 前缀不完整
+                break;
+            }
+            if (hdr < 0 || len > max_frame) {
+                error = true;
+                break;
+            }
+            size_t total = hdr + len + (checksum ? 4 : 0);
+            if (avail - pos < total) {  // 负载不完整
+                break;
+            }
+            frame_view view{begin + pos + hdr, static_cast<size_t>(len)};
+            if (checksum && load32(view.data + len) != crc32c(view.data, view.len)) {
+                error = true;
+                break;
+            }
+            pos += total;
+            ++frames;
+            if (!cb(view)) {
+                break;
+            }
+        }
+        in->retrieve(pos);
+        return error ? -1 : frames;
+    }
+
+    /**
+     * @brief 编码一帧并追加到缓冲区
+     * @param out 输出缓冲区
+     * @param data 负载
+     * @param len 负载字节数，不应超过max_frame
+     */
+    void encode(buffer* out, const char* data, size_t len) {
+        char hdr[max_header];
+        char crc[4];
+        size_t hdr_len = encode_header(hdr, len);
+        out->append(hdr, hdr_len);
+        out->append(data, len);
+        if (checksum) {
+            store32(crc, crc32c(data, len));
+            out->append(crc, 4);
+        }
+    }
+
+    /**
+     * @brief 编码长度前缀
+     * @param hdr 至少max_header字节的空间
+     * @param len 负载字节数
+     * @return 前缀的字节数
+     */
+    size_t encode_header(char* hdr, size_t len) const {
+        assert(len <= max_frame);
+        if (format == length_format::fixed16) {
+            hdr[0] = static_cast<char>(len >> 8);
+            hdr[1] = static_cast<char>(len);
+            return 2;
+        }
+        if (format == length_format::fixed32) {
+            store32(hdr, static_cast<uint32_t>(len));
+            return 4;
+        }
+        size_t n = 0;
+        do {
+            hdr[n++] = static_cast<char>((len & 0x7f) | (len > 0x7f ? 0x80 : 0));
+            len >>= 7;
+        } while (len);
+        return n;
+    }
+
+    /**
+     * @brief 以一次writev发送一帧，负载不经过额外的复制，未能立即发送的部分进入连接的输出缓冲区
+     * @param rec 连接所在的反应堆
+     * @param conn 连接
+     * @param data 负载
+     * @param len 负载字节数
+     */
+    void send(reactor* rec, connection* conn, const char* data, size_t len) {
+        char hdr[max_header];
+        char crc[4];
+        struct iovec iov[3];
+        iov[0].iov_base = hdr;
+        iov[0].iov_len = encode_header(hdr, len);
+        iov[1].iov_base = const_cast<char*>(data);
+        iov[1].iov_len = len;
+        if (checksum) {
+            store32(crc, crc32c(data, len));
+            iov[2].iov_base = crc;
+            iov[2].iov_len = 4;
+        }
+        rec->send(conn, iov, checksum ? 3 : 2);
+    }
+
+    /**
+     * @brief 生成按帧回调的连接消息回调，用于add_connection或connection::set_message_cb
+     * @param cb 回调void(connection*, frame_view)，每个完整帧调用一次
+     * @return 消息回调；解码出错时关闭连接，回调中关闭连接时停止交付
+     */
+    template <typename F, typename = typename std::enable_if<nc::details::is_runnable<F, connection*, frame_view>::value>::type>
+    connection_callback_t wrap(F&& cb) {
+        frame_codec codec = *this;
+        std::function<void(connection*, frame_view)> on_frame(std::forward<F>(cb));
+        return [codec, on_frame](connection* conn) mutable {
+            int n = codec.decode(conn->input(), [conn, &on_frame](frame_view view) {
+                on_frame(conn, view);
+                return !conn->is_closed();
+            });
+            if (n < 0 && !conn->is_closed()) {
+                conn->get_reactor()->close_connection(conn);
+            }
+        };
+    }
+
+private:
+    // 解析长度前缀，返回前缀字节数；数据不足时返回0，格式错误时返回-1
+    int parse_header(const char* p, size_t avail, uint64_t* len) const {
+        if (format == length_format::fixed16) {
+            if (avail < 2) {
+                return 0;
+            }
+            *len = (static_cast<uint64_t>(static_cast<unsigned char>(p[0])) << 8) | static_cast<unsigned char>(p[1]);
+            return 2;
+        }
+        if (format == length_format::fixed32) {
+            if (avail < 4) {
+                return 0;
+            }
+            *len = load32(p);
+            return 4;
+        }
+        uint64_t value = 0;
+        for (int i = 0; i < max_header; ++i) {
+            if (static_cast<size_t>(i) >= avail) {
+                return 0;
+            }
+            unsigned char byte = static_cast<unsigned char>(p[i]);
+            value |= static_cast<uint64_t>(byte & 0x7f) << (7 * i);
+            if (!(byte & 0x80)) {
+                *len = value;
+                return i + 1;
+            }
+        }
+        return -1;  // 超过5字节的变长整数
+    }
+
+    static uint32_t load32(const char* p) {
+        auto* u = reinterpret_cast<const unsigned char*>(p);
+        return (static_cast<uint32_t>(u[0]) << 24) | (static_cast<uint32_t>(u[1]) << 16) |
+               (static_cast<uint32_t>(u[2]) << 8) | static_cast<uint32_t>(u[3]);
+    }
+
+    static void store32(char* p, uint32_t v) {
+        p[0] = static_cast<char>(v >> 24);
+        p[1] = static_cast<char>(v >> 16);
+        p[2] = static_cast<char>(v >> 8);
+        p[3] = static_cast<char>(v);
+    }
+};
+
+}  // namespace nc::net
@@ -0,0 +1,147 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <map>
+#include "nancy/details/type_traits.h"
+#include "nancy/net/buffer.h"
+#include "nancy/net/details/typedef.h"
+
+namespace nc::net {
+
+/**
+ * @brief 由reactor管理的带缓冲的TCP连接
+ * @note  reactor负责读取数据到输入缓冲区、发送输出缓冲区中的数据，并仅在有待发送数据时关注可写事件
+ * @note  连接对象的生命周期由reactor管理，关闭后不应再持有其指针
+ */
+class connection {
+    friend class reactor;
+    friend class creactors;
+
+    // 等待内核完成通知的零拷贝发送
+    struct zerocopy_entry {
+        uint32_t id;       // 内核为每次成功的MSG_ZEROCOPY发送分配的递增序号
+        bool done;
+        callback_t release;
+    };
+
+    // 排在输出缓冲区数据之间、等待发送的文件区间
+    struct file_segment {
+        int fd;
+        off_t offset;
+        size_t remaining;
+        size_t preceding;  // 输出缓冲区中须在该文件之前发送的字节数（相对上一个文件）
+        bool pipe;         // 源为管道时使用splice
+        callback_t done;
+    };
+
+    int fd = -1;
+    handle_t handle = handle::null;
+    reactor* owner = nullptr;  // 所在的反应堆，迁移时随之更新
+    bool closed = false;
+    bool corked = false;  // 已加入反应堆本轮循环末尾的发送列表
+    int8_t zerocopy = 0;  // SO_ZEROCOPY状态: 0未设置，1已开启，-1不可用或内核退化为复制
+    uint32_t zerocopy_next = 0;
+    buffer in;
+    buffer out;
+    std::deque<zerocopy_entry> zerocopy_pending = {};
+    std::deque<file_segment> files = {};
+    size_t file_bytes = 0;      // 文件区间中待发送的字节数
+    size_t file_preceding = 0;  // 各文件区间preceding之和，输出缓冲区中超出部分排在所有文件之后
+    bool timed_out = false;     // 因空闲或发送超时被关闭
+    uint32_t idle_ticks = 0;    // 空闲超时(时间轮刻度)，0为不限
+    uint32_t write_ticks = 0;   // 发送超时(时间轮刻度)，0为不限
+    uint64_t active_tick = 0;   // 最近一次读到数据的刻度
+    uint64_t write_since = 0;   // 输出开始积压的刻度，0为没有积压
+    uint64_t wheel_tick = 0;    // 在时间轮中的截止刻度，0为不在轮中
+    uint64_t read_total = 0;    // 累计读入的字节数
+    uint64_t read_mark = 0;     // 上一次再平衡时的read_total，只由creactors使用
+    uint64_t offload_next = 0;       // 下一个交给线程池的任务序号
+    uint64_t offload_delivered = 0;  // 下一个应交付结果的任务序号
+    std::map<uint64_t, connection_callback_t> offload_ready = {};  // 提前完成、等待按序交付的结果
+    connection_callback_t message_cb = {};
+    connection_callback_t retired = {};  // 在执行中被替换的消息回调，回调返回后释放
+    bool dispatching = false;            // 正在执行消息回调
+    bool detaching = false;              // 已登记在本轮循环末尾摘下(detach_connection_later)
+    connection_callback_t close_cb = {};
+
+public:
+    connection(int fd, handle_t handle)
+        : fd(fd)
+        , handle(handle) {}
+    connection(const connection&) = delete;
+    connection& operator=(const connection&) = delete;
+    ~connection() = default;
+
+public:
+    // 获取内部fd
+    int get_fd() const noexcept {
+        return fd;
+    }
+
+    // 获取连接所在的反应堆，仅在该反应堆的线程中使用
+    reactor* get_reactor() const noexcept {
+        return owner;
+    }
+
+    // 获取连接句柄，用于跨线程投递或定时任务中校验连接是否仍然存在，见reactor::post(handle_t, F)
+    handle_t get_handle() const noexcept {
+        return handle;
+    }
+
+    // 输入缓冲区，在消息回调中读取并消费
+    buffer* input() noexcept {
+        return &in;
+    }
+
+    // 输出缓冲区中待发送的数据
+    buffer* output() noexcept {
+        return &out;
+    }
+
+    // 待发送的字节数（包括send_file的文件区间）
+    size_t pending_bytes() const noexcept {
+        return out.readable_bytes() + file_bytes;
+    }
+
+    // 已交给线程池但尚未交付结果的任务数，见reactor::offload
+    size_t offload_inflight() const noexcept {
+        return offload_next - offload_delivered;
+    }
+
+    // 累计读入输入缓冲区的字节数
+    uint64_t read_bytes() const noexcept {
+        return read_total;
+    }
+
+    // 尚未被内核释放的零拷贝发送数
+    size_t zerocopy_inflight() const noexcept {
+        return zerocopy_pending.size();
+    }
+
+    // 连接是否已被关闭
+    bool is_closed() const noexcept {
+        return closed;
+    }
+
+    // 连接是否因空闲或发送超时而被反应堆关闭，可在关闭回调中区分关闭原因
+    bool is_timeout() const noexcept {
+        return timed_out;
+    }
+
+    // 替换消息回调，如连接池将连接交给新的使用者时；可在消息回调中调用，正在执行的回调在返回后才被释放
+    template <typename F, typename = typename std::enable_if<nc::details::is_runnable<F, connection*>::value>::type>
+    void set_message_cb(F&& cb) {
+        if (dispatching && !retired) {
+            retired = std::move(message_cb);
+        }
+        message_cb = std::forward<F>(cb);
+    }
+
+    // 设置连接关闭时的回调（对端关闭、出错或主动关闭）
+    template <typename F, typename = typename std::enable_if<nc::details::is_runnable<F, connection*>::value>::type>
+    void set_close_cb(F&& cb) {
+        close_cb = std::forward<F>(cb);
+    }
+};
+
+}  // namespace nc::net
@@ -0,0 +1,259 @@
+#pragma once
+#if !defined(__cpp_impl_coroutine) || __cpp_impl_coroutine < 201902L
+#error "Nancy-coroutine: C++20 coroutines are required (-std=c++20)"
+#endif
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <new>
+#include "nancy/net/reactor.h"
+
+namespace nc::net::co {
+
+/**
+ * @brief 协程帧分配器：按64字节分级的线程局部空闲链表
+ * @note  同一连接的协程帧大小固定，释放后立即被下一个连接复用，稳态下不再调用operator new
+ * @note  帧在哪个线程释放就归还到哪个线程的链表，跨线程释放是安全的
+ */
+class frame_pool {
+    struct block {
+        block* next;
+    };
+
+    static const size_t align = 64;
+    static const size_t classes = 64;  // 超过4KB的帧直接使用operator new
+    block* free_list[classes] = {};
+
+    frame_pool() = default;
+    ~frame_pool() {
+        for (auto head : free_list) {
+            while (head) {
+                block* next = head->next;
+                ::operator delete(head);
+                head = next;
+            }
+        }
+    }
+
+public:
+    frame_pool(const frame_pool&) = delete;
+    frame_pool& operator=(const frame_pool&) = delete;
+
+    // 当前线程的分配器
+    static frame_pool& local() {
+        thread_local frame_pool pool;
+        return pool;
+    }
+
+    void* allocate(size_t sz) {
+        size_t idx = (sz + align - 1) / align;
+        if (idx >= classes) {
+            return ::operator new(sz);
+        }
+        if (block* b = free_list[idx]) {
+            free_list[idx] = b->next;
+            return b;
+        }
+        return ::operator new(idx * align);
+    }
+
+    void deallocate(void* ptr, size_t sz) noexcept {
+        size_t idx = (sz + align - 1) / align;
+        if (idx >= classes) {
+            ::operator delete(ptr);
+            return;
+        }
+        block* b = static_cast<block*>(ptr);
+        b->next = free_list[idx];
+        free_list[idx] = b;
+    }
+};
+
+/**
+ * @brief 分离式协程任务：调用即开始执行，结束时自动释放协程帧
+ * @note  协程中的异常会终止程序，请在协程内部处理
+ * @note  协程在反应堆线程中恢复执行，因此只应在反应堆线程中启动
+ */
+class task {
+public:
+    struct promise_type {
+        task get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+
+        static void* operator new(size_t sz) {
+            return frame_pool::local().allocate(sz);
+        }
+        static void operator delete(void* ptr, size_t sz) noexcept {
+            frame_pool::local().deallocate(ptr, sz);
+        }
+    };
+};
+
+// 等待fd上的事件
+class event_awaiter {
+    reactor& rec;
+    int fd;
+    event_t ev;
+
+public:
+    event_awaiter(reactor& rec, int fd, event_t ev)
+        : rec(rec), fd(fd), ev(ev) {}
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h) {
+        rec.wait_event(fd, ev, [h](int) { h.resume(); });
+    }
+    void await_resume() const noexcept {}
+};
+
+// 读取一次，数据未就绪时挂起等待
+class read_awaiter {
+    reactor& rec;
+    int fd;
+    void* buf;
+    size_t len;
+    ssize_t res = 0;
+
+    bool try_read() noexcept {
+        while ((res = ::read(fd, buf, len)) < 0 && errno == EINTR) {}
+        if (res < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return false;
+            }
+            res = -errno;
+        }
+        return true;
+    }
+
+public:
+    read_awaiter(reactor& rec, int fd, void* buf, size_t len)
+        : rec(rec), fd(fd), buf(buf), len(len) {}
+
+    bool await_ready() noexcept { return try_read(); }  // 先尝试读取，数据已就绪时不注册事件
+    void await_suspend(std::coroutine_handle<> h) {
+        rec.wait_event(fd, event::readable, [this, h](int) {
+            if (try_read()) {
+                h.resume();
+            } else {
+                rec.reset_event(fd, event::readable, pattern::lt_oneshot);  // 虚假唤醒
+            }
+        });
+    }
+    ssize_t await_resume() const noexcept { return res; }
+};
+
+// 写入全部数据，发送缓冲区满时挂起等待
+class write_awaiter {
+    reactor& rec;
+    int fd;
+    const char* buf;
+    size_t len;
+    size_t done = 0;
+    ssize_t err = 0;
+
+    bool try_write() noexcept {
+        while (done < len) {
+            ssize_t bytes = ::send(fd, buf + done, len - done, MSG_NOSIGNAL);
+            if (bytes < 0 && errno == ENOTSOCK) {
+                bytes = ::write(fd, buf + done, len - done);
+            }
+            if (bytes >= 0) {
+                done += bytes;
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return false;
+            } else if (errno != EINTR) {
+                err = -errno;
+                return true;
+            }
+        }
+        return true;
+    }
+
+public:
+    write_awaiter(reactor& rec, int fd, const void* buf, size_t len)
+        : rec(rec), fd(fd), buf(static_cast<const char*>(buf)), len(len) {}
+
+    bool await_ready() noexcept { return try_write(); }
+    void await_suspend(std::coroutine_handle<> h) {
+        rec.wait_event(fd, event::writable, [this, h](int) {
+            if (try_write()) {
+                h.resume();
+            } else {
+                rec.reset_event(fd, event::writable, pattern::lt_oneshot);
+            }
+        });
+    }
+    ssize_t await_resume() const noexcept { return err ? err : static_cast<ssize_t>(done); }
+};
+
+// 挂起一段时间
+class sleep_awaiter {
+    reactor& rec;
+    int ms;
+
+public:
+    sleep_awaiter(reactor& rec, int ms)
+        : rec(rec), ms(ms) {}
+
+    bool await_ready() const noexcept { return ms <= 0; }
+    void await_suspend(std::coroutine_handle<> h) {
+        rec.run_after(ms, [h] { h.resume(); });
+    }
+    void await_resume() const noexcept {}
+};
+
+/**
+ * @brief 等待fd可读
+ * @note 连接断开时同样会恢复，随后的读取将返回0或错误
+ */
+inline event_awaiter readable(reactor& rec, int fd) {
+    return event_awaiter(rec, fd, event::readable);
+}
+
+// 等待fd可写
+inline event_awaiter writable(reactor& rec, int fd) {
+    return event_awaiter(rec, fd, event::writable);
+}
+
+/**
+ * @brief 从非阻塞fd读取最多len字节
+ * @return 读取的字节数，0为对端关闭，失败时返回-errno
+ */
+inline read_awaiter async_read(reactor& rec, int fd, void* buf, size_t len) {
+    return read_awaiter(rec, fd, buf, len);
+}
+
+/**
+ * @brief 向非阻塞fd写入全部len字节
+ * @return 成功时返回len，失败时返回-errno
+ * @note 套接字以MSG_NOSIGNAL发送，对端关闭时不会产生SIGPIPE
+ */
+inline write_awaiter async_write(reactor& rec, int fd, const void* buf, size_t len) {
+    return write_awaiter(rec, fd, buf, len);
+}
+
+// 挂起ms毫秒，期间反应堆继续处理其它事件
+inline sleep_awaiter sleep_for(reactor& rec, std::chrono::milliseconds ms) {
+    return sleep_awaiter(rec, static_cast<int>(ms.count()));
+}
+
+/**
+ * @brief 从反应堆中移除并关闭fd，协程结束前调用
+ * @note 全部读写都未挂起过的fd不曾注册到反应堆，此时只关闭
+ */
+inline void close(reactor& rec, int fd) {
+    if (rec.contains(fd)) {
+        rec.remove_socket(fd);
+    }
+    ::close(fd);
+}
+
+}  // namespace nc::net::co
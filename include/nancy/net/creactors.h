@@ -1,6 +1,11 @@
 #pragma once 
 #include "nancy/net/reactor.h"
+#include "nancy/net/details/affinity.h"
+#include "nancy/details/queue.h"
 #include "nancy/details/type_traits.h"
+#include <algorithm>
+#include <atomic>
+#include <string>
 #include <vector>
 #include <thread>
 
@@ -8,6 +13,9 @@ namespace nc::net {
 
 /**
  * @brief 并发多节点反应堆(concurrent reactors)，采用one-thread-per-loop + 监听端口反应堆分发套接字的模式实现高性能服务
+ * @note  根节点经每个节点的无锁SPSC队列转交完整的fd，每批新连接对每个节点至多唤醒一次
+ * @note  根节点按set_dispatch设置的策略选择节点，节点负载由原子计数器维护，读取无需加锁
+ * @note  连接可在节点间迁移(migrate)，set_rebalance使负载过高的节点定期迁出最繁忙的连接
  * @note  接口并未被刻意设计为线程安全
  * @note  除activate外其它接口均为非阻塞的
  * @note  在activate时异步线程才被创建，此前的所有设置才生效。因此回调设置接口在activate前是可重入的。
@@ -17,51 +25,103 @@ class creactors {
 
     // 异步反应堆节点
     class async_node {
+        // 先于反应堆声明、后于反应堆析构：io_uring后端的请求被取消后再关闭，监听套接字随close同步释放
+        std::unique_ptr<net::tcp_serv_socket> listen_sock;  // SO_REUSEPORT模式下节点自己的监听套接字
         net::reactor rec;
-        net::sockpair pair;
-        std::unique_ptr<char[]> req_buf;
+        nc::details::spsc_queue<int> queue;                 // 根节点转交的新连接，根节点为唯一的生产者
+        std::atomic<bool> scheduled = {false};              // 已投递取出队列的任务且尚未执行
+        std::atomic<uint64_t> handed = {0};                 // 根节点转交的连接数，只有根节点写入
+        std::atomic<uint64_t> taken = {0};                  // 节点已取出的连接数，只有节点写入
     public:
-        static const int bufsz = 128;
-        async_node(int timeout)
-            : rec(timeout) 
-            , pair() {
-            req_buf.reset(new char[bufsz]);
-        } 
+        async_node(int timeout, backend_t engine)
+            : rec(timeout, engine) 
+            , queue(config::handoff_queue_size) {} 
         ~async_node() = default;
     public:
-        net::sockpair* channel() {
-            return &pair;
+        nc::details::spsc_queue<int>* channel() {
+            return &queue;
         }
         net::reactor*  reactor() {
             return &rec;
         }
-        char* buffer() {
-            return req_buf.get();
+        std::unique_ptr<net::tcp_serv_socket>& listener() {
+            return listen_sock;
+        }
+        // 生产者在一批连接入队后调用，返回true时需要投递取出任务
+        bool schedule() {
+            return !scheduled.exchange(true, std::memory_order_acq_rel);
+        }
+        // 消费者在取出队列前调用，此后入队的连接会再次投递任务
+        void unschedule() {
+            scheduled.exchange(false, std::memory_order_acq_rel);
+        }
+        // 计数器各自只有一个写入方，以relaxed的load/store代替原子读改写
+        void hand_over() {
+            handed.store(handed.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+        void take() {
+            taken.store(taken.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+        // 节点负载：已管理的connection个数 + 已转交但尚未取出的连接数
+        uint64_t load() const {
+            uint64_t out = handed.load(std::memory_order_relaxed);
+            uint64_t in = taken.load(std::memory_order_relaxed);
+            return rec.connection_nums() + (out > in ? out - in : 0);
         }
     };
     using node_ptr = std::shared_ptr<async_node>;
 
 private:
     int  cur = 0;   
+    dispatch_t policy = dispatch::round_robin;
+    uint64_t rand_state = 0x9e3779b97f4a7c15ULL;  // p2c的xorshift随机数状态
+    static const int virtual_points = 64;         // 一致性哈希中每个节点的虚拟节点数
     bool stop = false;
+    bool accept_retrying = false;  // 接受连接出错，已设置重试的定时任务
     bool initialized = false;
+    int busy_poll_us = 0;
+    bool cork = false;
+    bool reuseport = false;     // 各节点独立监听并接受连接
+    bool steering = false;      // 按CPU选择监听套接字
+    std::string listen_ip = {};
+    int listen_port = 0;
+    int idle_timeout = 0;
+    int write_timeout = 0;
+    int root_cpu = -1;          // 根节点(调用activate的线程)绑定的CPU，-1为不绑定
+    std::vector<int> cpus;      // 第i个工作节点绑定cpus[i % cpus.size()]，为空时不绑定
+    size_t compute_nums = 0;    // 计算线程池的线程数，0为不创建
+    int rebalance_ms = 0;       // 自动再平衡的检查周期，0为关闭
+    dispatch_t rebalance_metric = dispatch::least_connections;
     static const char default_node_nums = 4;
+    backend_t engine = backend::epoll;
 
+    net::tcp_serv_socket sock;  // 后于根节点析构，见async_node
     net::reactor root_node;
-    net::tcp_serv_socket sock;
     std::vector<int> failures;
     std::vector<node_ptr> nodes;
+    std::vector<char> touched;  // 本批中收到新连接的节点
+    std::vector<std::pair<uint32_t, int>> ring;  // 一致性哈希环：(哈希值, 节点下标)，按哈希值有序
     std::vector<std::thread> workers;
+    std::unique_ptr<nc::details::work_stealing_pool> pool;  // 所有节点共用，先于节点析构
 
     net::reactor_callback_t timeout_cb = {};
     net::reactor_socket_callback_t conn_cb = {};
     net::reactor_socket_callback_t readable_cb = {};
     net::reactor_socket_callback_t writable_cb = {};
     net::reactor_socket_callback_t disconnect_cb = {};
+    net::reactor_connection_callback_t message_cb = {};
 
 public:
-    explicit creactors() {}
-    ~creactors() { destroy(); }
+    /**
+     * @param engine 所有节点(包括根节点)使用的IO后端，默认为epoll
+     */
+    explicit creactors(backend_t engine = backend::epoll)
+        : engine(engine)
+        , root_node(-1, engine) {}
+    ~creactors() {
+        destroy();
+        join_threads();
+    }
 
 public:
     auto root() -> reactor* {
@@ -75,24 +135,64 @@ public:
     void bind_serv_socket(tcp_serv_socket&& tmp) { 
         sock = std::move(tmp);
         net::set_nonblocking(sock.get_fd());
-        root_node.add_socket(sock.get_fd(), event::readable, pattern::et, [this](int){ 
-            int fd = 0;
-            int bytes = 0;
-            int old = cur;
-            while ((fd = sock.accept_req()) > 0) {
-                while ((bytes = nodes[cur]->channel()->write_lfd((char*)&fd, sizeof(uint16_t))) != 2) {
-                    cur = (cur + 1) % nodes.size();  // 向前查找
-                    if (cur == old) {
-                        failures.push_back(fd);      // 推入溢出缓冲区的文件描述符
-                    }
-                } 
-                cur = (cur+1) % nodes.size();        // 负载均衡
-                old = cur;
+        root_node.add_socket(sock.get_fd(), event::readable, pattern::et, [this](int listen_fd){ 
+            int fds[config::accept_batch];
+            struct sockaddr_in peers[config::accept_batch];
+            // 新连接由accept4直接设为非阻塞；每次最多接受一批，其余通过就绪列表在下一轮继续
+            int nums = sock.accept_batch(fds, config::accept_batch, SOCK_NONBLOCK | SOCK_CLOEXEC,
+                                         policy == dispatch::consistent_hash ? peers : nullptr);
+            int err = errno;
+            for (int i = 0; i < nums; ++i) {
+                size_t idx = pick_node(peers[i]);
+                size_t tries = 0;
+                while (!nodes[idx]->channel()->push(fds[i]) && ++tries < nodes.size()) {
+                    idx = (idx + 1) % nodes.size();  // 队列已满，向前查找
+                }
+                if (tries == nodes.size()) {
+                    failures.push_back(fds[i]);      // 所有节点的队列均已满，推入溢出缓冲区
+                    continue;
+                }
+                nodes[idx]->hand_over();
+                touched[idx] = 1;
+            }
+            // 每个节点每批至多唤醒一次
+            for (size_t i = 0; i < nodes.size(); ++i) {
+                if (touched[i]) {
+                    touched[i] = 0;
+                    notify(nodes[i].get());
+                }
+            }
+            if (nums == config::accept_batch) {
+                root_node.requeue(listen_fd);
+            } else if (err != EAGAIN && err != EWOULDBLOCK && !accept_retrying) {
+                // ET模式不会再通知队列中剩余的连接，稍后重试，期间关闭的fd可供使用
+                accept_retrying = true;
+                root_node.run_after(config::accept_retry_ms, [this, listen_fd] {
+                    accept_retrying = false;
+                    root_node.requeue(listen_fd);
+                });
             }
         });
         initialized = true;
     }
     
+    /**
+     * @brief 以SO_REUSEPORT模式监听：每个工作节点拥有自己的监听套接字并直接接受连接，根节点不参与连接的分发
+     * @param ip 地址
+     * @param port 端口
+     * @param cpu_steering 是否挂载CBPF程序，使连接交给与接收数据包的CPU序号对应的节点(cpu % 节点数)
+     * @note 与bind_serv_socket二选一。监听套接字在activate时按节点顺序创建，失败时抛出异常；
+     *       省去了根节点accept与转交fd的开销，连接建立的吞吐量随节点数扩展
+     * @note cpu_steering需要节点线程与CPU一一对应才能保持局部性，内核不支持时退化为哈希分配
+     */
+    void bind_reuseport(const char* ip, int port, bool cpu_steering = false) {
+        reuseport = true;
+        steering = cpu_steering;
+        listen_ip = ip;
+        listen_port = port;
+        initialized = true;
+    }
+
     /**    
      * @brief 初始化异步工作节点。如果不进行初始化，creactors的工作节点数被设置为4
      * @param nums 异步工作节点个数
@@ -101,7 +201,7 @@ public:
     void init_async_nodes(int nums, int timeout = -1) {
         assert(nums > 0);
         for (int i = 0; i < nums; ++i) {
-            nodes.emplace_back(new async_node(timeout));
+            nodes.emplace_back(new async_node(timeout, engine));
         }
         
     }
@@ -132,6 +232,17 @@ public:
         conn_cb = std::forward<F>(cb);
     }
 
+    /**
+     * @brief 设置节点统一的消息回调，新连接将作为带缓冲的connection交由工作节点管理
+     * @tparam F 可执行对象
+     * @param cb 回调类型为void(reactor*, connection*)，在输入缓冲区读入新数据时调用
+     * @note 优先级低于set_connect_cb
+     */
+    template <typename F, typename = typename std::enable_if<nc::details::is_runnable<F, reactor*, connection*>::value>::type>
+    void set_message_cb(F&& cb) {
+        message_cb = std::forward<F>(cb);
+    }
+
     /**
      * @brief 工作节点统一可读回调
      * @tparam F 可执行对象，参数为int
@@ -172,6 +283,145 @@ public:
         disconnect_cb = std::forward<F>(cb);
     }
 
+    /**
+     * @brief 设置根节点分发新连接的策略，默认为轮询
+     * @param p dispatch::round_robin/least_connections/p2c_connections/p2c_lag/consistent_hash
+     * @note 负载为节点中set_message_cb(或自行add_connection)管理的connection个数加上已转交但尚未取出的连接数，
+     *       以add_socket注册的fd不计入，此时基于负载的策略只能感知尚未取出的连接
+     * @note p2c_lag比较节点最近的定时任务滞后，只有节点运行定时任务(如连接超时)时才有采样，相同时比较负载
+     * @note consistent_hash按客户端IP选择节点，同一客户端的连接总是交给同一节点
+     * @note 只作用于bind_serv_socket，SO_REUSEPORT模式下连接由内核分配
+     */
+    void set_dispatch(dispatch_t p) {
+        policy = p;
+    }
+
+    /**
+     * @brief 工作节点统一的混合轮询模式，见reactor::set_busy_poll
+     * @param us 有事件到来后以0超时轮询的时长(微秒)，0为关闭
+     */
+    void set_busy_poll(int us) {
+        busy_poll_us = us;
+    }
+
+    /**
+     * @brief 工作节点统一的写合并模式，见reactor::set_cork
+     * @param on 是否开启
+     */
+    void set_cork(bool on) {
+        cork = on;
+    }
+
+    /**
+     * @brief 工作节点统一的连接超时，见reactor::set_conn_timeout，只作用于set_message_cb管理的连接
+     * @param idle_ms 空闲超时(毫秒)，0为不限
+     * @param write_ms 发送超时(毫秒)，0为不限
+     */
+    void set_conn_timeout(int idle_ms, int write_ms) {
+        idle_timeout = idle_ms;
+        write_timeout = write_ms;
+    }
+
+    /**
+     * @brief 将工作节点与根节点绑定到指定CPU，节点此后分配的内存优先来自该CPU所在的NUMA节点
+     * @param node_cpus 第i个工作节点绑定node_cpus[i % node_cpus.size()]，为空时不绑定
+     * @param root 根节点绑定的CPU，根节点运行在调用activate的线程中，因此绑定的是该线程；-1为不绑定
+     * @note 绑定失败(CPU不存在或不被cgroup允许)时节点照常运行，不抛出异常
+     * @note 节点线程在激活前设置内存策略，运行中增长的fd表、连接缓冲区、数据报缓冲区等均为节点本地内存；
+     *       构造时的少量固定分配(事件数组、转交队列)仍来自构造creactors的线程
+     * @note 配合bind_reuseport的cpu_steering时，第i个节点应绑定在CPU i上
+     */
+    void set_cpu_affinity(const std::vector<int>& node_cpus, int root = -1) {
+        cpus = node_cpus;
+        root_cpu = root;
+    }
+
+    /**
+     * @brief 将工作节点放置在指定NUMA节点的CPU上，内存优先来自该节点
+     * @param numa NUMA节点序号
+     * @param root 根节点绑定的CPU，-1为不绑定
+     * @return 节点不存在或系统不支持NUMA时返回false，设置不变
+     */
+    bool set_numa_node(int numa, int root = -1) {
+        auto local = numa_cpus(numa);
+        if (local.empty()) {
+            return false;
+        }
+        set_cpu_affinity(local, root);
+        return true;
+    }
+
+    /**
+     * @brief 将工作节点放置在网卡所在NUMA节点的CPU上，见set_numa_node
+     * @param ifname 网卡名，如"eth0"
+     * @param root 根节点绑定的CPU，-1为不绑定
+     * @return 网卡的NUMA节点未知(虚拟网卡、单节点系统)时返回false，设置不变
+     */
+    bool set_numa_device(const char* ifname, int root = -1) {
+        return set_numa_node(numa_node_of_device(ifname), root);
+    }
+
+    /**
+     * @brief 创建所有工作节点共用的工作窃取线程池，用于offload
+     * @param nums 线程数，0为硬件线程数
+     * @note 线程池在activate时创建，计算任务分散到空闲的核上，节点的事件循环不被阻塞
+     */
+    void set_compute_threads(size_t nums) {
+        compute_nums = nums ? nums : std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    /**
+     * @brief 将计算任务交给共用的线程池，结果在连接所在节点的线程中按提交顺序交付，见reactor::offload
+     * @param rec 连接所在的节点，即回调中的reactor*
+     * @param conn 连接
+     * @param work 在线程池中执行的任务，类型为R()，R可为void
+     * @param done 结果回调，类型为void(connection*, R)，R为void时为void(connection*)
+     * @note 仅在节点线程中调用，需要先调用set_compute_threads
+     */
+    template <typename W, typename D>
+    void offload(reactor* rec, connection* conn, W&& work, D&& done) {
+        assert(pool);
+        rec->offload(*pool, conn, std::forward<W>(work), std::forward<D>(done));
+    }
+
+    /**
+     * @brief 将连接连同回调、缓冲区与超时设置迁移到另一个工作节点
+     * @param from 连接当前所在的节点，即回调中的reactor*
+     * @param conn 连接
+     * @param to 目标节点下标
+     * @return 不能迁移(见reactor::detach_connection)或目标即为当前节点时返回false，连接留在原节点
+     * @note 仅在from的线程中调用，可以在连接的消息回调中调用，返回true后不应再使用conn；连接在from本轮循环的
+     *       回调全部返回后摘下(reactor::detach_connection_later)，此前关闭则不再迁移；迁移后连接的句柄改变
+     * @note set_message_cb管理的连接迁移后，消息回调收到的reactor*为新节点；自行添加的连接
+     *       应在回调中以connection::get_reactor获取所在节点，而不是捕获添加时的reactor*
+     */
+    bool migrate(reactor* from, connection* conn, unsigned to) {
+        auto* target = nodes[to]->reactor();
+        if (target == from) {
+            return false;
+        }
+        return from->detach_connection_later(conn, [target](std::unique_ptr<connection> res) {
+            if (!res) {
+                return;
+            }
+            // 未能执行的投递随任务一同析构，连接对象不会泄漏
+            auto holder = std::make_shared<std::unique_ptr<connection>>(std::move(res));
+            target->post([target, holder] { target->attach_connection(std::move(*holder)); });
+        });
+    }
+
+    /**
+     * @brief 开启自动再平衡：每个工作节点定期与最空闲的节点比较负载，明显偏高时将最繁忙的连接迁过去
+     * @param interval_ms 检查周期(毫秒)，0为关闭
+     * @param metric dispatch::least_connections按node_load，迁出两者差值的一半；
+     *               dispatch::p2c_lag按最近的循环滞后，超过config::rebalance_lag_us且超过最空闲节点的两倍时迁出一个
+     * @note 每次至多迁出config::rebalance_batch个，优先迁出上一周期读入字节最多的连接；只作用于connection
+     */
+    void set_rebalance(int interval_ms, dispatch_t metric = dispatch::least_connections) {
+        rebalance_ms = interval_ms;
+        rebalance_metric = metric;
+    }
+
     /**
      * @brief 激活反应堆
      * @note 若未初始化异步节点，则默认生成default_node_nums个节点
@@ -181,24 +431,46 @@ public:
         if (nodes.empty()) {
             init_async_nodes(default_node_nums);
         }
+        if (reuseport) {
+            create_listeners();
+        }
+        touched.assign(nodes.size(), 0);
+        if (policy == dispatch::consistent_hash) {
+            build_ring();
+        }
+        // 在创建线程前确定统一的连接回调，各工作线程只读取
+        if (!conn_cb && message_cb) {
+            auto tmp_msg_cb = message_cb;
+            conn_cb = [tmp_msg_cb](reactor* rec, int fd){  // fd已由accept4设为非阻塞
+                // 所在节点在回调时获取，连接迁移后随之改变
+                rec->add_connection(fd, [tmp_msg_cb](connection* conn){ tmp_msg_cb(conn->get_reactor(), conn); });
+            };
+        } else if (!conn_cb) {
+            conn_cb = [](reactor* rec, int fd){
+                rec->add_socket(fd, event::readable, pattern::et);
+            };
+        }
+        if (compute_nums) {
+            pool.reset(new nc::details::work_stealing_pool(compute_nums));
+        }
         create_threads();
+        if (root_cpu >= 0) {
+            place_thread(root_cpu);
+        }
         root_node.activate();
     }
 
     /**
      * @brief 主动关闭并发反应堆（非阻塞），否则在析构函数关闭
-     * @note 该函数指示异步反应堆关闭并将线程分离以完成最后的工作
+     * @note 该函数指示各反应堆在本轮循环结束后退出；工作线程的回调持有this，析构函数等待工作线程退出
      */
     void destroy() {
-        if (stop) {
+        if (!stop) {
             stop = true;
             root_node.destroy();
             for (auto& ptr: nodes) {
                 ptr->reactor()->destroy();  
             }
-            for (auto& thrd: workers) {
-                thrd.detach();
-            }
         }
     }   
 
@@ -212,39 +484,217 @@ public:
         return nodes[idx]->reactor();
     }
 
+    /**
+     * @brief 获取所有工作节点的循环指标快照，线程安全
+     * @return 下标与operator[]一致
+     */
+    std::vector<loop_metrics> metrics() {
+        std::vector<loop_metrics> res;
+        res.reserve(nodes.size());
+        for (auto& ptr : nodes) {
+            res.push_back(ptr->reactor()->metrics());
+        }
+        return res;
+    }
+
+    /**
+     * @brief 获取工作节点的负载，线程安全
+     * @param idx 节点下标
+     * @return connection个数加上已转交但尚未取出的连接数
+     */
+    uint64_t node_load(unsigned idx) {
+        return nodes[idx]->load();
+    }
+
 
 private:
+    // SO_REUSEPORT模式下按节点顺序创建监听套接字，组内序号与节点下标一致
+    void create_listeners() {
+        for (auto& ptr : nodes) {
+            std::unique_ptr<tcp_serv_socket> listener(new tcp_serv_socket());
+            net::set_reuse_address(listener->get_fd());
+            net::set_reuse_port(listener->get_fd());
+            listener->listen_req(listen_ip.c_str(), listen_port);
+            ptr->listener() = std::move(listener);
+        }
+        if (steering) {
+            net::set_reuseport_cpu_steering(nodes[0]->listener()->get_fd(), static_cast<unsigned>(nodes.size()));
+        }
+    }
+
+    // 唤醒节点取出转交的连接，节点尚未处理上一次唤醒时不再投递
+    void notify(async_node* node) {
+        if (node->schedule()) {
+            node->reactor()->post([this, node] {
+                node->unschedule();
+                node->channel()->drain([this, node](int fd) {
+                    conn_cb(node->reactor(), fd);
+                    node->take();  // 在连接计入节点之后，避免负载短暂偏低
+                });
+            });
+        }
+    }
+
+    // 再平衡使用的节点负载
+    uint64_t rebalance_load(size_t idx) {
+        return rebalance_metric == dispatch::p2c_lag ? nodes[idx]->reactor()->recent_lag() : nodes[idx]->load();
+    }
+
+    // 在节点线程中执行：与最空闲的节点比较负载，将上一周期最繁忙的连接迁过去
+    void rebalance(size_t idx) {
+        size_t target = idx;
+        uint64_t mine = rebalance_load(idx);
+        uint64_t least = mine;
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            uint64_t l = rebalance_load(i);
+            if (l < least) {
+                least = l;
+                target = i;
+            }
+        }
+        size_t moves = 0;
+        if (rebalance_metric == dispatch::p2c_lag) {
+            moves = target != idx && mine > config::rebalance_lag_us && mine > 2 * least;
+        } else if (mine > least + 1) {
+            moves = std::min<size_t>((mine - least) / 2, config::rebalance_batch);
+        }
+        // 每个周期都更新读入标记，使繁忙程度只反映上一周期
+        auto* rec = nodes[idx]->reactor();
+        std::vector<std::pair<uint64_t, connection*>> busy;
+        rec->for_each_connection([&busy, moves](connection* conn) {
+            if (moves) {
+                busy.emplace_back(conn->read_total - conn->read_mark, conn);
+            }
+            conn->read_mark = conn->read_total;
+        });
+        moves = std::min(moves, busy.size());
+        std::partial_sort(busy.begin(), busy.begin() + moves, busy.end(),
+                          [](const std::pair<uint64_t, connection*>& a, const std::pair<uint64_t, connection*>& b) {
+                              return a.first > b.first;
+                          });
+        for (size_t i = 0; i < moves; ++i) {
+            migrate(rec, busy[i].second, static_cast<unsigned>(target));
+        }
+    }
+
+    // 按分发策略选择节点，peer只在consistent_hash时有效
+    size_t pick_node(const struct sockaddr_in& peer) {
+        size_t n = nodes.size();
+        switch (policy) {
+        case dispatch::least_connections: {
+            // 从轮询位置开始查找，负载相同时退化为轮询
+            size_t best = cur;
+            uint64_t least = nodes[cur]->load();
+            for (size_t i = 1; i < n && least; ++i) {
+                size_t idx = (cur + i) % n;
+                uint64_t l = nodes[idx]->load();
+                if (l < least) {
+                    least = l;
+                    best = idx;
+                }
+            }
+            cur = (best + 1) % n;
+            return best;
+        }
+        case dispatch::p2c_connections:
+        case dispatch::p2c_lag: {
+            if (n == 1) {
+                return 0;
+            }
+            uint64_t r = next_random();
+            size_t a = r % n;
+            size_t b = (a + 1 + (r >> 32) % (n - 1)) % n;  // 与a不同的节点
+            if (policy == dispatch::p2c_lag) {
+                uint64_t la = nodes[a]->reactor()->recent_lag();
+                uint64_t lb = nodes[b]->reactor()->recent_lag();
+                if (la != lb) {
+                    return la < lb ? a : b;
+                }
+            }
+            return nodes[a]->load() <= nodes[b]->load() ? a : b;
+        }
+        case dispatch::consistent_hash: {
+            uint32_t h = mix(peer.sin_addr.s_addr);
+            auto it = std::lower_bound(ring.begin(), ring.end(), std::make_pair(h, 0));
+            return it == ring.end() ? ring.front().second : it->second;
+        }
+        default: {
+            size_t idx = cur;
+            cur = (cur + 1) % n;
+            return idx;
+        }
+        }
+    }
+
+    // 构建一致性哈希环，每个节点对应virtual_points个虚拟节点
+    void build_ring() {
+        ring.clear();
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            for (int v = 0; v < virtual_points; ++v) {
+                ring.emplace_back(mix(static_cast<uint32_t>(i * virtual_points + v) ^ 0x5bd1e995u), static_cast<int>(i));
+            }
+        }
+        std::sort(ring.begin(), ring.end());
+    }
+
+    // murmur3的32位混合函数
+    static uint32_t mix(uint32_t h) {
+        h ^= h >> 16;
+        h *= 0x85ebca6bu;
+        h ^= h >> 13;
+        h *= 0xc2b2ae35u;
+        h ^= h >> 16;
+        return h;
+    }
+
+    // xorshift64，只在根节点线程中使用
+    uint64_t next_random() {
+        rand_state ^= rand_state << 13;
+        rand_state ^= rand_state >> 7;
+        rand_state ^= rand_state << 17;
+        return rand_state;
+    }
+
+    // 等待工作线程退出；在工作线程中析构时无法等待自身，将其分离
+    void join_threads() {
+        for (auto& thrd: workers) {
+            if (!thrd.joinable()) {
+                continue;
+            }
+            if (thrd.get_id() == std::this_thread::get_id()) {
+                thrd.detach();
+            } else {
+                thrd.join();
+            }
+        }
+    }
+
     // 创建工作线程
     void create_threads() {
         for (size_t i = 0; i < nodes.size(); ++i) {
-            workers.emplace_back(&creactors::worker, this, nodes[i]);
+            workers.emplace_back(&creactors::worker, this, i, cpus.empty() ? -1 : cpus[i % cpus.size()]);
+        }
+    }
+
+    // 将调用线程绑定到CPU，并优先使用所在NUMA节点的内存
+    static void place_thread(int cpu) {
+        if (pin_thread(cpu)) {
+            prefer_numa_node(numa_node_of_cpu(cpu));
         }
     }
 
     // 工作线程
-    void worker(node_ptr context) {
+    void worker(size_t idx, int cpu) {
+        node_ptr context = nodes[idx];
+        if (cpu >= 0) {
+            place_thread(cpu);  // 先于节点的一切运行期分配
+        }
         auto* rec = context->reactor();
-        char* buf = context->buffer();
-        int bufsz = async_node::bufsz;
-        int notify_fd = context->channel()->get_rfd();
-        net::set_nonblocking(notify_fd);  
 
-        if (!conn_cb) {
-            conn_cb = [](reactor* rec, int fd){
-                set_nonblocking(fd); 
-                rec->add_socket(fd, event::readable, pattern::et);
-            };
+        // SO_REUSEPORT模式下由节点自己接受连接
+        if (context->listener()) {
+            rec->add_acceptor(context->listener()->get_fd(), [this, rec](int fd) { conn_cb(rec, fd); });
         }
-        // init pipe
-        rec->add_socket(notify_fd, event::readable, pattern::et, [&](int){
-            int bytes = 0;
-            while ((bytes = read(notify_fd, buf, bufsz)) > 0) {
-                auto array = (uint16_t*)(buf);
-                for (int i = 0; i < (bytes/2); ++i) {
-                    conn_cb(rec, (int)array[i]);
-                }
-            }
-        });
 
         // 以定制的回调为更高优先级
         if (readable_cb && !rec->get_readable_cb()) {
@@ -264,6 +714,19 @@ private:
             rec->set_timeout_cb([tmp_tout_cb, rec](){ tmp_tout_cb(rec); });
         }
 
+        if (busy_poll_us > 0) {
+            rec->set_busy_poll(busy_poll_us);
+        }
+        if (cork) {
+            rec->set_cork(true);
+        }
+        if (idle_timeout || write_timeout) {
+            rec->set_conn_timeout(idle_timeout, write_timeout);
+        }
+        if (rebalance_ms > 0) {
+            rec->run_every(rebalance_ms, [this, idx] { rebalance(idx); });
+        }
+
         // 激活反应堆
         rec->activate();
     }
@@ -0,0 +1,123 @@
+#pragma once
+#include <dirent.h>
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace nc::net {
+
+/**
+ * @brief 解析sysfs中的CPU列表格式，如"0-3,8,10-11"
+ * @return CPU序号，格式错误的部分被忽略
+ */
+static inline std::vector<int> parse_cpu_list(const std::string& list) {
+    std::vector<int> cpus;
+    size_t pos = 0;
+    while (pos < list.size()) {
+        size_t end = list.find(',', pos);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        std::string item = list.substr(pos, end - pos);
+        size_t dash = item.find('-');
+        char* tail = nullptr;
+        long first = strtol(item.c_str(), &tail, 10);
+        if (tail != item.c_str()) {
+            long last = dash == std::string::npos ? first : strtol(item.c_str() + dash + 1, nullptr, 10);
+            for (long cpu = first; cpu <= last; ++cpu) {
+                cpus.push_back(static_cast<int>(cpu));
+            }
+        }
+        pos = end + 1;
+    }
+    return cpus;
+}
+
+/**
+ * @brief 将调用线程绑定到指定的CPU集合
+ * @return 失败(如CPU不存在或不在cgroup允许的集合中)时返回false，线程亲和性不变
+ */
+static inline bool pin_thread(const std::vector<int>& cpus) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    return CPU_COUNT(&set) > 0 && pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+static inline bool pin_thread(int cpu) {
+    return pin_thread(std::vector<int>{cpu});
+}
+
+/**
+ * @brief 获取NUMA节点上的CPU
+ * @return 节点不存在或系统不支持NUMA时为空
+ */
+static inline std::vector<int> numa_cpus(int node) {
+    std::ifstream in("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    std::string list;
+    if (node < 0 || !std::getline(in, list)) {
+        return {};
+    }
+    return parse_cpu_list(list);
+}
+
+/**
+ * @brief 获取CPU所在的NUMA节点
+ * @return 未知时返回-1
+ */
+static inline int numa_node_of_cpu(int cpu) {
+    std::string path = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+    DIR* dir = opendir(path.c_str());
+    if (!dir) {
+        return -1;
+    }
+    int node = -1;
+    while (struct dirent* entry = readdir(dir)) {  // 目录下的nodeN链接指向所在节点
+        if (!strncmp(entry->d_name, "node", 4) && entry->d_name[4] >= '0' && entry->d_name[4] <= '9') {
+            node = atoi(entry->d_name + 4);
+            break;
+        }
+    }
+    closedir(dir);
+    return node;
+}
+
+/**
+ * @brief 获取网卡所在的NUMA节点
+ * @param ifname 网卡名，如"eth0"
+ * @return 虚拟网卡、单节点系统或未知时返回-1
+ */
+static inline int numa_node_of_device(const char* ifname) {
+    std::ifstream in(std::string("/sys/class/net/") + ifname + "/device/numa_node");
+    int node = -1;
+    if (!(in >> node)) {
+        return -1;
+    }
+    return node;
+}
+
+/**
+ * @brief 调用线程此后分配的内存优先来自指定的NUMA节点(MPOL_PREFERRED)，节点内存不足时仍可使用其它节点
+ * @return 失败时返回false，内存策略不变
+ * @note 内存在首次访问时才分配物理页，因此只影响此后首次访问的内存
+ */
+static inline bool prefer_numa_node(int node) {
+    if (node < 0 || node >= static_cast<int>(sizeof(unsigned long) * 8)) {
+        return false;
+    }
+    unsigned long mask = 1UL << node;
+    return syscall(SYS_set_mempolicy, MPOL_PREFERRED, &mask, sizeof(mask) * 8) == 0;
+}
+
+}  // namespace nc::net
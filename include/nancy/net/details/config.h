@@ -0,0 +1,71 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace nc::net::config {
+
+// epoll_wait单次最多返回的事件数
+static const int max_events = 1024;
+
+// epoll事件数组的初始长度。数组被填满时扩容为2倍(不超过max_events)，
+// 连续event_shrink_rounds轮不足1/4时缩容为一半(不低于min_events)
+static const int min_events = 64;
+static const int event_shrink_rounds = 128;
+
+// io_uring提交队列长度，完成队列为其4倍，以容纳multishot请求的突发完成事件
+static const unsigned uring_entries = 512;
+
+// io_uring提供给multishot recv的缓冲区个数（必须为2的幂）及每个缓冲区的字节数
+static const unsigned uring_buf_nums = 256;
+static const unsigned uring_buf_size = 16 * 1024;
+
+// epoll后端receiver使用的接收缓冲区字节数
+static const unsigned recv_buf_size = 16 * 1024;
+
+// 小于该字节数的零拷贝发送退化为普通发送。内核需要为零拷贝固定页面并发送完成通知，小块数据直接复制更快
+static const size_t zerocopy_threshold = 10 * 1024;
+
+// 连接空闲/发送超时所用时间轮的刻度(毫秒)与槽数，超时精度为一个刻度
+static const int wheel_tick_ms = 100;
+static const size_t wheel_slots = 512;
+
+// 监听套接字默认的全连接队列长度，内核会将其截断为net.core.somaxconn
+static const int listen_backlog = 4096;
+
+// 每次可读事件最多接受的连接数，超出的部分留到下一轮，避免连接风暴时长时间占用反应堆
+static const int accept_batch = 64;
+
+// 接受连接因fd或内存耗尽(EMFILE/ENFILE/ENOBUFS/ENOMEM)失败时，ET模式的监听套接字隔该时间(毫秒)后重试
+static const int accept_retry_ms = 10;
+
+// creactors根节点向每个工作节点转交新连接的队列容量，队列满时转交给下一个节点
+static const size_t handoff_queue_size = 4096;
+
+// creactors自动再平衡时节点每次最多迁出的连接数
+static const int rebalance_batch = 8;
+
+// creactors按循环滞后再平衡时，节点最近滞后超过该值(微秒)才迁出连接
+static const uint64_t rebalance_lag_us = 1000;
+
+// upstream_pool中每个对端地址默认最多保留的空闲连接数
+static const size_t upstream_max_idle = 64;
+
+// upstream_pool中空闲连接默认的超时(毫秒)，超时后关闭
+static const int upstream_idle_ms = 60 * 1000;
+
+// upstream_pool建立连接默认的超时(毫秒)
+static const int upstream_connect_ms = 3000;
+
+// frame_codec默认允许的最大帧长度(字节)，超出时视为协议错误
+static const size_t max_frame_size = 16 * 1024 * 1024;
+
+// UDP批量收发时每次系统调用最多处理的数据报个数
+static const int udp_batch = 32;
+
+// 数据报接收缓冲区的字节数。开启UDP_GRO时内核可能将多个数据报合并交付，最长可达64KB
+static const size_t udp_buf_size = 64 * 1024;
+
+// 一次UDP_SEGMENT发送最多切分出的数据报个数（内核限制）
+static const int udp_max_segments = 64;
+
+}  // namespace nc::net::config
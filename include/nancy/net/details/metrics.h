@@ -0,0 +1,189 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+namespace nc::net {
+
+// 回调的分类，用于按事件类型统计耗时
+using callback_kind_t = int;
+namespace callback_kind {
+static const callback_kind_t readable = 0;
+static const callback_kind_t writable = 1;
+static const callback_kind_t disconnect = 2;
+static const callback_kind_t task = 3;   // post/run_in_loop投递的任务
+static const callback_kind_t timer = 4;  // 一轮到期的全部定时任务
+static const callback_kind_t nums = 5;
+}  // namespace callback_kind
+
+/**
+ * @brief 反应堆循环指标的快照，各项均为自反应堆启动以来的累计值
+ * @note  分布直方图按2的幂分桶，第0桶为0，第k桶为[2^(k-1), 2^k)，最后一桶包含更大的值
+ */
+struct loop_metrics {
+    static const int batch_buckets = 12;    // 每次唤醒的事件数: 0, 1, [2,4) ... [1024,∞)
+    static const int latency_buckets = 16;  // 回调耗时(微秒): [0,1), [1,2), [2,4) ... [16384,∞)
+
+    struct callback_stats {
+        uint64_t calls = 0;
+        uint64_t total_ns = 0;
+        uint64_t max_ns = 0;
+        uint64_t histogram[latency_buckets] = {};
+    };
+
+    uint64_t wakeups = 0;  // epoll_wait/io_uring_enter返回的次数
+    uint64_t events = 0;   // 处理的事件总数
+    uint64_t max_batch = 0;
+    uint64_t batch_histogram[batch_buckets] = {};
+    callback_stats callbacks[callback_kind::nums] = {};
+
+    // 循环延迟：定时任务实际执行时刻相对截止时间的滞后
+    uint64_t lag_samples = 0;
+    uint64_t lag_total_us = 0;
+    uint64_t lag_max_us = 0;
+    uint64_t lag_recent_us = 0;  // 最近滞后的指数加权平均(权重1/8)
+
+    uint64_t connections = 0;       // 当前由反应堆管理的connection个数
+    uint64_t interest_updates = 0;  // 修改fd兴趣集的次数(epoll_ctl MOD或io_uring重新注册)
+};
+
+/**
+ * @brief 反应堆线程写入、任意线程读取的循环指标
+ * @note  只有反应堆线程写入，因此以relaxed的load/store代替原子读改写，写入方没有锁总线的开销
+ * @note  快照中的各项分别读取，彼此之间不保证严格一致
+ */
+class loop_recorder {
+    using counter_t = std::atomic<uint64_t>;
+
+    struct callback_counters {
+        counter_t calls = {0};
+        counter_t total_ns = {0};
+        counter_t max_ns = {0};
+        counter_t histogram[loop_metrics::latency_buckets];
+    };
+
+    counter_t wakeups = {0};
+    counter_t events = {0};
+    counter_t max_batch = {0};
+    counter_t batch_histogram[loop_metrics::batch_buckets];
+    callback_counters callbacks[callback_kind::nums];
+    counter_t lag_samples = {0};
+    counter_t lag_total_us = {0};
+    counter_t lag_max_us = {0};
+    counter_t lag_recent_us = {0};
+    counter_t connections = {0};
+    counter_t interest_updates = {0};
+
+public:
+    loop_recorder() {
+        for (auto& c : batch_histogram) {
+            c.store(0, std::memory_order_relaxed);
+        }
+        for (auto& cb : callbacks) {
+            for (auto& c : cb.histogram) {
+                c.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+    loop_recorder(const loop_recorder&) = delete;
+    loop_recorder& operator=(const loop_recorder&) = delete;
+
+private:
+    static void add(counter_t& c, uint64_t v) noexcept {
+        c.store(c.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+    }
+
+    static void update_max(counter_t& c, uint64_t v) noexcept {
+        if (v > c.load(std::memory_order_relaxed)) {
+            c.store(v, std::memory_order_relaxed);
+        }
+    }
+
+    static int bucket(uint64_t v, int buckets) noexcept {
+        int idx = v ? 64 - __builtin_clzll(v) : 0;
+        return idx < buckets ? idx : buckets - 1;
+    }
+
+    static uint64_t get(const counter_t& c) noexcept {
+        return c.load(std::memory_order_relaxed);
+    }
+
+public:
+    // 记录一次唤醒及其返回的事件数
+    void wakeup(int nums) noexcept {
+        uint64_t n = nums > 0 ? static_cast<uint64_t>(nums) : 0;
+        add(wakeups, 1);
+        add(events, n);
+        update_max(max_batch, n);
+        add(batch_histogram[bucket(n, loop_metrics::batch_buckets)], 1);
+    }
+
+    // 记录一次回调的耗时
+    void callback(callback_kind_t kind, uint64_t ns) noexcept {
+        auto& cb = callbacks[kind];
+        add(cb.calls, 1);
+        add(cb.total_ns, ns);
+        update_max(cb.max_ns, ns);
+        add(cb.histogram[bucket(ns / 1000, loop_metrics::latency_buckets)], 1);
+    }
+
+    // 记录一次定时任务的滞后
+    void lag(uint64_t us) noexcept {
+        add(lag_samples, 1);
+        add(lag_total_us, us);
+        update_max(lag_max_us, us);
+        uint64_t recent = get(lag_recent_us);
+        lag_recent_us.store(recent - recent / 8 + us / 8, std::memory_order_relaxed);
+    }
+
+    // 记录connection的加入与关闭
+    void connection_opened() noexcept {
+        add(connections, 1);
+    }
+
+    void connection_closed() noexcept {
+        connections.store(get(connections) - 1, std::memory_order_relaxed);
+    }
+
+    // 记录一次兴趣集的修改
+    void interest_update() noexcept {
+        add(interest_updates, 1);
+    }
+
+    // 当前的connection个数，线程安全，供负载均衡频繁读取
+    uint64_t live_connections() const noexcept {
+        return get(connections);
+    }
+
+    // 最近的循环滞后(微秒)，线程安全
+    uint64_t recent_lag() const noexcept {
+        return get(lag_recent_us);
+    }
+
+    // 获取快照，线程安全
+    loop_metrics snapshot() const noexcept {
+        loop_metrics m;
+        m.wakeups = get(wakeups);
+        m.events = get(events);
+        m.max_batch = get(max_batch);
+        for (int i = 0; i < loop_metrics::batch_buckets; ++i) {
+            m.batch_histogram[i] = get(batch_histogram[i]);
+        }
+        for (int k = 0; k < callback_kind::nums; ++k) {
+            m.callbacks[k].calls = get(callbacks[k].calls);
+            m.callbacks[k].total_ns = get(callbacks[k].total_ns);
+            m.callbacks[k].max_ns = get(callbacks[k].max_ns);
+            for (int i = 0; i < loop_metrics::latency_buckets; ++i) {
+                m.callbacks[k].histogram[i] = get(callbacks[k].histogram[i]);
+            }
+        }
+        m.lag_samples = get(lag_samples);
+        m.lag_total_us = get(lag_total_us);
+        m.lag_max_us = get(lag_max_us);
+        m.lag_recent_us = get(lag_recent_us);
+        m.connections = get(connections);
+        m.interest_updates = get(interest_updates);
+        return m;
+    }
+};
+
+}  // namespace nc::net
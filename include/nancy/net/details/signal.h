@@ -3,16 +3,16 @@
 
 namespace nc::net {
 
-// 信号服务目前是单例模式
+// 信号由各反应堆的signalfd接收，此处为进程/线程级的辅助设置
 
-// 初始化信号服务，返回读信号端socket
-int  signal_socket_init();
+// 在调用线程中屏蔽信号，此后由该线程创建的线程继承屏蔽字
+void signal_block(int sig);
 
-// 添加信号
-void signal_add(int sig);
+// 在调用线程中解除屏蔽
+void signal_unblock(int sig);
 
-// 关闭信号服务
-void signal_socket_close();
+// 忽略信号(如SIGPIPE)
+void signal_ignore(int sig);
 
 
-}  // namespace nc::net::_net
\ No newline at end of file
+}  // namespace nc::net::_net
@@ -0,0 +1,144 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <set>
+#include <unordered_map>
+#include <utility>
+
+namespace nc::net {
+
+// 定时任务句柄，0为无效句柄
+using timer_id = uint64_t;
+
+/**
+ * @brief 反应堆内部使用的定时任务队列（毫秒精度）
+ * @note  基于红黑树按截止时间排序，增删均为log(n)
+ * @note  非线程安全，只应在反应堆所在线程中使用
+ */
+class timer_queue {
+public:
+    using clock_t = std::chrono::steady_clock;
+    using timestamp_t = clock_t::time_point;
+    using callback_t = std::function<void()>;
+
+private:
+    struct entry {
+        timestamp_t deadline;
+        std::chrono::milliseconds interval;  // 为0时表示一次性任务
+        callback_t cb;
+    };
+
+    timer_id next_id = 1;
+    timer_id running = 0;            // 正在执行的周期任务
+    bool running_cancelled = false;  // 周期任务在自身回调中被取消
+    std::set<std::pair<timestamp_t, timer_id>> queue = {};
+    std::unordered_map<timer_id, entry> entries = {};
+
+public:
+    /**
+     * @brief 添加定时任务
+     * @param delay 首次触发的延迟(毫秒)
+     * @param interval 周期(毫秒)，为0时只触发一次
+     * @param cb 回调
+     * @return 定时任务句柄
+     */
+    template <typename F>
+    timer_id add(int64_t delay, int64_t interval, F&& cb) {
+        timer_id id = next_id++;
+        auto deadline = clock_t::now() + std::chrono::milliseconds(delay < 0 ? 0 : delay);
+        entries.emplace(id, entry{deadline, std::chrono::milliseconds(interval < 0 ? 0 : interval),
+                                  callback_t(std::forward<F>(cb))});
+        queue.emplace(deadline, id);
+        return id;
+    }
+
+    /**
+     * @brief 取消定时任务
+     * @return 任务存在且被取消时返回true
+     */
+    bool cancel(timer_id id) {
+        if (id == running) {
+            bool ret = !running_cancelled;
+            running_cancelled = true;
+            return ret;
+        }
+        auto it = entries.find(id);
+        if (it == entries.end()) {
+            return false;
+        }
+        queue.erase(std::make_pair(it->second.deadline, id));
+        entries.erase(it);
+        return true;
+    }
+
+    bool empty() const noexcept {
+        return queue.empty();
+    }
+
+    size_t size() const noexcept {
+        return entries.size();
+    }
+
+    /**
+     * @brief 距离最近的截止时间还有多少毫秒（向上取整）
+     * @param now 当前时间
+     * @return 没有定时任务时返回-1
+     */
+    int next_timeout(timestamp_t now) const {
+        if (queue.empty()) {
+            return -1;
+        }
+        return millis_until(queue.begin()->first, now);
+    }
+
+    // 最近的截止时间，队列不能为空
+    timestamp_t earliest() const {
+        return queue.begin()->first;
+    }
+
+    // 计算到达deadline的毫秒数（向上取整），已过期时返回0
+    static int millis_until(timestamp_t deadline, timestamp_t now) {
+        if (deadline <= now) {
+            return 0;
+        }
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count();
+        if (deadline > now + std::chrono::milliseconds(ms)) {
+            ++ms;
+        }
+        return ms > INT32_MAX ? INT32_MAX : static_cast<int>(ms);
+    }
+
+    /**
+     * @brief 执行所有已到期的任务，周期任务以当前时间为基准重新排期
+     * @param now 当前时间
+     */
+    void expire(timestamp_t now) {
+        while (!queue.empty() && queue.begin()->first <= now) {
+            timer_id id = queue.begin()->second;
+            queue.erase(queue.begin());
+            auto it = entries.find(id);
+            if (it->second.interval.count() == 0) {
+                callback_t cb = std::move(it->second.cb);
+                entries.erase(it);
+                cb();
+                continue;
+            }
+            // 回调中添加新任务可能使unordered_map重新哈希，迭代器随之失效，只有元素的引用保持有效；
+            // 正在执行的任务在回调中被取消时延后删除，因此引用在回调后仍然有效
+            entry& e = it->second;
+            running = id;
+            running_cancelled = false;
+            e.cb();
+            running = 0;
+            if (running_cancelled) {
+                entries.erase(id);
+            } else {
+                e.deadline = now + e.interval;
+                queue.emplace(e.deadline, id);
+            }
+        }
+    }
+};
+
+}  // namespace nc::net
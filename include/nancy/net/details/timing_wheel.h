@@ -0,0 +1,82 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "nancy/net/details/typedef.h"
+
+namespace nc::net {
+
+/**
+ * @brief 反应堆内部使用的时间轮，以句柄为元素、以刻度(tick)为时间单位
+ * @note  添加与每个刻度的推进均摊为O(1)；元素不支持删除，到期时由使用者校验句柄与刻度后丢弃过期项
+ * @note  超过一圈的截止刻度先放入最远的槽，到达后再重新放入，因此截止刻度不受槽数限制
+ * @note  非线程安全，只应在反应堆所在线程中使用
+ */
+class timing_wheel {
+    struct entry {
+        handle_t h;
+        uint64_t tick;  // 截止刻度
+    };
+
+    uint64_t current = 1;  // 当前刻度，从1开始，0供使用者表示"未设置"
+    size_t nums = 0;       // 轮中的元素个数（含过期项）
+    std::vector<std::vector<entry>> slots;
+    std::vector<entry> expired = {};
+
+public:
+    explicit timing_wheel(size_t slot_nums)
+        : slots(slot_nums) {}
+
+public:
+    // 当前刻度
+    uint64_t now() const noexcept {
+        return current;
+    }
+
+    bool empty() const noexcept {
+        return nums == 0;
+    }
+
+    // 轮为空时直接跳到指定刻度
+    void skip_to(uint64_t tick) {
+        if (nums == 0 && tick > current) {
+            current = tick;
+        }
+    }
+
+    /**
+     * @brief 添加元素
+     * @param h 句柄
+     * @param tick 截止刻度，不晚于当前刻度时在下一刻度到期
+     */
+    void add(handle_t h, uint64_t tick) {
+        place(entry{h, tick > current ? tick : current + 1});
+        ++nums;
+    }
+
+    /**
+     * @brief 推进一个刻度，对到期的元素调用expire(handle_t, uint64_t tick)
+     * @note expire中可以再次添加元素
+     */
+    template <typename F>
+    void advance(F&& expire) {
+        ++current;
+        expired.swap(slots[current % slots.size()]);
+        for (auto& e : expired) {
+            if (e.tick > current) {  // 超过一圈的元素，重新放入
+                place(e);
+            } else {
+                --nums;
+                expire(e.h, e.tick);
+            }
+        }
+        expired.clear();
+    }
+
+private:
+    void place(const entry& e) {
+        uint64_t last = current + slots.size() - 1;
+        slots[(e.tick < last ? e.tick : last) % slots.size()].push_back(e);
+    }
+};
+
+}  // namespace nc::net
@@ -1,5 +1,9 @@
 #pragma once
+#include <netinet/in.h>
 #include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/types.h>
+#include <cstdint>
 #include <functional>
 
 namespace nc::net {
@@ -27,14 +31,64 @@ namespace pattern {
     static const pattern_t et_oneshot = EPOLLET | EPOLLONESHOT;
 };
 
+// reactor's io backends
+using backend_t = uint8_t;
+namespace backend {
+    static const backend_t epoll = 0;
+    static const backend_t uring = 1;  // io_uring，需要Linux 5.19+
+};
+
+// creactors根节点分发新连接的策略
+using dispatch_t = uint8_t;
+namespace dispatch {
+    static const dispatch_t round_robin = 0;        // 轮询
+    static const dispatch_t least_connections = 1;  // 负载最小的节点
+    static const dispatch_t p2c_connections = 2;    // 随机两个节点中负载较小者
+    static const dispatch_t p2c_lag = 3;            // 随机两个节点中循环滞后较小者
+    static const dispatch_t consistent_hash = 4;    // 按客户端地址一致性哈希
+};
+
+// frame_codec的长度前缀格式
+using length_format_t = uint8_t;
+namespace length_format {
+    static const length_format_t varint = 0;   // LEB128变长整数，1~5字节
+    static const length_format_t fixed16 = 1;  // 2字节，网络字节序
+    static const length_format_t fixed32 = 2;  // 4字节，网络字节序
+};
+
+// 连接句柄：低32位为fd，高32位为该fd在反应堆中的代数(generation)
+// fd每次注册到反应堆或从中移除时代数递增，因此fd号被内核复用后旧句柄即失效
+using handle_t = uint64_t;
+namespace handle {
+    static const handle_t null = 0;
+
+    inline handle_t make(int fd, uint32_t generation) {
+        return (static_cast<handle_t>(generation) << 32) | static_cast<uint32_t>(fd);
+    }
+
+    inline int fd_of(handle_t h) {
+        return static_cast<int>(static_cast<uint32_t>(h));
+    }
+
+    inline uint32_t generation_of(handle_t h) {
+        return static_cast<uint32_t>(h >> 32);
+    }
+};
+
 
 class reactor;
+class connection;
 
 // 回调类型
 using callback_t = typename std::function<void()>;
 using socket_callback_t = typename std::function<void(int)>;
 using reactor_socket_callback_t = typename std::function<void(reactor*, int)>;
 using reactor_callback_t = typename std::function<void(reactor*)>;
+using receive_callback_t = typename std::function<void(int, const char*, ssize_t)>;
+using connection_callback_t = typename std::function<void(connection*)>;
+using reactor_connection_callback_t = typename std::function<void(reactor*, connection*)>;
+using datagram_callback_t = typename std::function<void(int, const char*, size_t, const struct sockaddr_in&)>;
+using signal_callback_t = typename std::function<void(const signalfd_siginfo&)>;
 
 
 }
\ No newline at end of file
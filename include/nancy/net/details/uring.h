@@ -0,0 +1,294 @@
+#pragma once
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace nc::net {
+
+/**
+ * @brief 基于原生系统调用的轻量io_uring封装，不依赖liburing
+ * @note  提交请求只写入共享内存，在submit/wait时才批量进入内核
+ * @note  非线程安全，只应在反应堆所在线程中使用
+ */
+class uring {
+    int ring_fd = -1;
+    unsigned entries = 0;
+
+    // 提交队列
+    unsigned* sq_head = nullptr;
+    unsigned* sq_tail = nullptr;
+    unsigned* sq_array = nullptr;
+    unsigned sq_mask = 0;
+    io_uring_sqe* sqes = nullptr;
+    unsigned sqe_tail = 0;    // 本地已准备的尾部
+    unsigned sqe_pushed = 0;  // 已发布给内核的尾部
+
+    // 完成队列
+    unsigned* cq_head = nullptr;
+    unsigned* cq_tail = nullptr;
+    unsigned cq_mask = 0;
+    io_uring_cqe* cqes = nullptr;
+
+    // 映射的内存
+    void* sq_ptr = MAP_FAILED;
+    void* cq_ptr = MAP_FAILED;
+    size_t sq_sz = 0;
+    size_t cq_sz = 0;
+    size_t sqes_sz = 0;
+
+    // 提供给内核的缓冲区环(provided buffer ring)
+    // 注意C++中io_uring_buf_ring的柔性数组布局与C不同，这里直接按io_uring_buf数组访问，尾部与首项的resv字段重叠
+    io_uring_buf* buf_ring = nullptr;
+    size_t buf_ring_sz = 0;
+    unsigned buf_nums = 0;
+    unsigned buf_size = 0;
+    unsigned short buf_tail = 0;
+    char* bufs = nullptr;
+
+public:
+    // provided buffer ring的缓冲区组号
+    static const unsigned short buf_group = 0;
+
+    explicit uring(unsigned sq_entries) {
+        io_uring_params p;
+        memset(&p, 0, sizeof(p));
+        p.flags = IORING_SETUP_CQSIZE | IORING_SETUP_COOP_TASKRUN;
+        p.cq_entries = sq_entries * 4;
+        ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, sq_entries, &p));
+        if (ring_fd < 0 && errno == EINVAL) {  // 旧内核不支持COOP_TASKRUN
+            p.flags &= ~IORING_SETUP_COOP_TASKRUN;
+            ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, sq_entries, &p));
+        }
+        if (ring_fd < 0) {
+            throw std::runtime_error(std::string("Nancy-uring: ")+strerror(errno));
+        }
+        if (!(p.features & IORING_FEAT_EXT_ARG) || !(p.features & IORING_FEAT_NODROP)) {
+            close(ring_fd);
+            throw std::runtime_error("Nancy-uring: kernel is too old (5.11+ required)");
+        }
+        entries = p.sq_entries;
+
+        sq_sz = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cq_sz = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        if (p.features & IORING_FEAT_SINGLE_MMAP) {
+            sq_sz = cq_sz = (sq_sz > cq_sz ? sq_sz : cq_sz);
+        }
+        sq_ptr = mmap(nullptr, sq_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+        if (p.features & IORING_FEAT_SINGLE_MMAP) {
+            cq_ptr = sq_ptr;
+        } else if (sq_ptr != MAP_FAILED) {
+            cq_ptr = mmap(nullptr, cq_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+        }
+        sqes_sz = p.sq_entries * sizeof(io_uring_sqe);
+        void* sqes_ptr = MAP_FAILED;
+        if (cq_ptr != MAP_FAILED) {
+            sqes_ptr = mmap(nullptr, sqes_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+        }
+        if (sqes_ptr == MAP_FAILED) {
+            int err = errno;
+            unmap();
+            close(ring_fd);
+            throw std::runtime_error(std::string("Nancy-uring: ")+strerror(err));
+        }
+        sqes = static_cast<io_uring_sqe*>(sqes_ptr);
+
+        char* sq = static_cast<char*>(sq_ptr);
+        sq_head = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+        sq_tail = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+        sq_mask = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+        sq_array = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+        sqe_tail = sqe_pushed = *sq_tail;
+
+        char* cq = static_cast<char*>(cq_ptr);
+        cq_head = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+        cq_mask = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+    }
+    uring(const uring&) = delete;
+    uring& operator=(const uring&) = delete;
+    ~uring() {
+        if (bufs) {
+            delete[] bufs;
+        }
+        if (buf_ring) {
+            munmap(buf_ring, buf_ring_sz);
+        }
+        unmap();
+        close(ring_fd);
+    }
+
+private:
+    void unmap() {
+        if (sqes) munmap(sqes, sqes_sz);
+        if (cq_ptr != MAP_FAILED && cq_ptr != sq_ptr) munmap(cq_ptr, cq_sz);
+        if (sq_ptr != MAP_FAILED) munmap(sq_ptr, sq_sz);
+    }
+
+    int enter(unsigned to_submit, unsigned min_complete, unsigned flags, void* arg, size_t argsz) {
+        return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, arg, argsz));
+    }
+
+    // 将本地准备好的请求发布给内核，返回待提交的数量
+    unsigned publish() {
+        unsigned n = sqe_tail - sqe_pushed;
+        if (n) {
+            __atomic_store_n(sq_tail, sqe_tail, __ATOMIC_RELEASE);
+            sqe_pushed = sqe_tail;
+        }
+        return n;
+    }
+
+public:
+    /**
+     * @brief 获取一个空闲的提交项，提交队列满时先提交已有请求
+     * @return 已清零的提交项
+     */
+    io_uring_sqe* get_sqe() {
+        if (sqe_tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE) >= entries) {
+            submit();
+        }
+        unsigned idx = sqe_tail & sq_mask;
+        io_uring_sqe* sqe = &sqes[idx];
+        memset(sqe, 0, sizeof(*sqe));
+        sq_array[idx] = idx;
+        ++sqe_tail;
+        return sqe;
+    }
+
+    // 提交所有已准备的请求，不等待完成
+    int submit() {
+        unsigned n = publish();
+        if (!n) {
+            return 0;
+        }
+        int ret = 0;
+        while ((ret = enter(n, 0, 0, nullptr, 0)) < 0 && errno == EINTR) {}
+        return ret;
+    }
+
+    /**
+     * @brief 批量提交请求并等待至少一个完成事件
+     * @param timeout_ms 等待时间(毫秒)，-1为无限等待，0为不等待
+     * @return 失败时返回-errno(超时为-ETIME)
+     */
+    int submit_and_wait(int timeout_ms) {
+        unsigned n = publish();
+        bool ready = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE) != *cq_head;
+        int ret = 0;
+        if (ready) {  // 已有完成事件，只提交不等待
+            ret = n ? enter(n, 0, 0, nullptr, 0) : 0;
+        } else if (timeout_ms == 0) {  // 需要进入内核以运行延迟的完成任务
+            ret = enter(n, 0, IORING_ENTER_GETEVENTS, nullptr, 0);
+        } else if (timeout_ms < 0) {
+            ret = enter(n, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+        } else {
+            __kernel_timespec ts;
+            ts.tv_sec = timeout_ms / 1000;
+            ts.tv_nsec = static_cast<long long>(timeout_ms % 1000) * 1000000;
+            io_uring_getevents_arg arg;
+            memset(&arg, 0, sizeof(arg));
+            arg.ts = reinterpret_cast<uint64_t>(&ts);
+            ret = enter(n, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+        }
+        return ret < 0 ? -errno : ret;
+    }
+
+    /**
+     * @brief 取出一个完成事件（拷贝后立即归还给内核）
+     * @return 没有完成事件时返回false
+     */
+    bool peek(io_uring_cqe& out) {
+        unsigned head = *cq_head;
+        if (head == __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE)) {
+            return false;
+        }
+        out = cqes[head & cq_mask];
+        __atomic_store_n(cq_head, head + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+
+    /**
+     * @brief 取消所有挂起的请求并等待其完成，完成事件被丢弃
+     * @note 关闭io_uring时内核异步回收挂起的请求，期间仍持有其引用的文件（如监听端口）。
+     *       析构前调用可保证返回时这些文件已被释放
+     */
+    void cancel_all() {
+        const uint64_t marker = ~0ull;
+        io_uring_sqe* sqe = get_sqe();
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->fd = -1;
+        sqe->cancel_flags = IORING_ASYNC_CANCEL_ALL | IORING_ASYNC_CANCEL_ANY;
+        sqe->user_data = marker;
+        io_uring_cqe cqe;
+        for (bool done = false; !done;) {
+            int ret = submit_and_wait(100);
+            if (ret < 0 && ret != -EINTR && ret != -ETIME) {
+                return;
+            }
+            while (peek(cqe)) {
+                done = done || cqe.user_data == marker;
+            }
+        }
+        submit_and_wait(0);  // 运行被取消请求的收尾任务
+        while (peek(cqe)) {}
+    }
+
+    /**
+     * @brief 注册provided buffer ring，供multishot recv自动选择缓冲区
+     * @param nums 缓冲区个数，必须为2的幂
+     * @param size 每个缓冲区的字节数
+     */
+    void setup_buffers(unsigned nums, unsigned size) {
+        buf_ring_sz = nums * sizeof(io_uring_buf);
+        void* ptr = mmap(nullptr, buf_ring_sz, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (ptr == MAP_FAILED) {
+            throw std::runtime_error(std::string("Nancy-uring: ")+strerror(errno));
+        }
+        io_uring_buf_reg reg;
+        memset(&reg, 0, sizeof(reg));
+        reg.ring_addr = reinterpret_cast<uint64_t>(ptr);
+        reg.ring_entries = nums;
+        reg.bgid = buf_group;
+        if (syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+            int err = errno;
+            munmap(ptr, buf_ring_sz);
+            throw std::runtime_error(std::string("Nancy-uring: ")+strerror(err));
+        }
+        buf_ring = static_cast<io_uring_buf*>(ptr);
+        buf_nums = nums;
+        buf_size = size;
+        bufs = new char[static_cast<size_t>(nums) * size];
+        for (unsigned i = 0; i < nums; ++i) {
+            recycle(static_cast<unsigned short>(i));
+        }
+    }
+
+    bool has_buffers() const noexcept {
+        return buf_ring != nullptr;
+    }
+
+    // 获取缓冲区地址
+    char* buffer(unsigned short bid) const noexcept {
+        return bufs + static_cast<size_t>(bid) * buf_size;
+    }
+
+    // 将缓冲区归还给内核
+    void recycle(unsigned short bid) {
+        io_uring_buf* buf = &buf_ring[buf_tail & (buf_nums - 1)];
+        buf->addr = reinterpret_cast<uint64_t>(buffer(bid));
+        buf->len = buf_size;
+        buf->bid = bid;
+        ++buf_tail;
+        __atomic_store_n(&buf_ring[0].resv, buf_tail, __ATOMIC_RELEASE);
+    }
+};
+
+}  // namespace nc::net
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <fcntl.h>
+#include <linux/filter.h>
 #include <netdb.h>
 #include <netinet/tcp.h>
 #include <sys/socket.h>
@@ -19,6 +20,38 @@ static inline int set_nonblocking(int fd) {
     return old_option;
 }
 
+/**
+ * @brief 允许多个套接字绑定同一地址和端口(SO_REUSEPORT)，内核在这些监听套接字之间分配新连接
+ * @note 失败时抛出异常
+ */
+static inline void set_reuse_port(int fd) {
+    assert(fd >= 0);
+    int option = 1;
+    if (-1 == setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, (void*)&option, sizeof(option))) {
+        throw std::runtime_error(std::string("Nancy-fd: ")+std::string(strerror(errno)));
+    }
+}
+
+/**
+ * @brief 为SO_REUSEPORT组挂载CBPF程序，按处理数据包的CPU选择组内的监听套接字(cpu % nums)
+ * @param fd 组内任一已绑定的监听套接字
+ * @param nums 组内套接字个数，组内序号即绑定的先后顺序
+ * @return 内核不支持时返回false，此时仍按哈希分配
+ * @note 配合将第i个监听套接字交给绑定在CPU i上的线程，连接建立与后续处理都留在接收数据包的CPU上
+ */
+static inline bool set_reuseport_cpu_steering(int fd, unsigned nums) {
+    assert(fd >= 0 && nums > 0);
+    struct sock_filter code[] = {
+        {BPF_LD | BPF_W | BPF_ABS, 0, 0, static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_CPU)},  // A = 当前CPU
+        {BPF_ALU | BPF_MOD | BPF_K, 0, 0, nums},                                           // A = A % nums
+        {BPF_RET | BPF_A, 0, 0, 0},                                                         // 返回组内序号
+    };
+    struct sock_fprog prog;
+    prog.len = sizeof(code) / sizeof(code[0]);
+    prog.filter = code;
+    return setsockopt(fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof(prog)) == 0;
+}
+
 /**
  * @brief 快速复用端口
  * @note 失败时抛出异常
@@ -50,6 +83,17 @@ static inline void set_recv_bufsz(int sock, socklen_t size) {
     }
 }
 
+// 获取非阻塞连接的结果(SO_ERROR)，0为已连接，否则为错误码
+static inline int get_connect_error(int sock) {
+    assert(sock >= 0);
+    int err = 0;
+    socklen_t len = sizeof(err);
+    if (-1 == getsockopt(sock, SOL_SOCKET, SO_ERROR, &err, &len)) {
+        return errno;
+    }
+    return err;
+}
+
 // 获取当前TCP发送缓冲区大小
 static inline int get_send_bufsz(int sock) {
     assert(sock >= 0);
@@ -1,22 +1,39 @@
 #pragma once
 #include <arpa/inet.h>
 #include <fcntl.h>
+#include <linux/errqueue.h>
+#include <netinet/in.h>
 #include <signal.h>
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/sendfile.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #include <cerrno>
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
-#include <unordered_map>
+#include <deque>
 #include <map>
 #include <vector>
 #include <memory>
 #include <functional>
+#include <thread>
+#include <utility>
 
+#include "nancy/net/connection.h"
+#include "nancy/net/details/config.h"
+#include "nancy/net/details/metrics.h"
 #include "nancy/net/details/signal.h"
+#include "nancy/net/details/timer_queue.h"
+#include "nancy/net/details/timing_wheel.h"
 #include "nancy/net/details/typedef.h"
+#include "nancy/net/details/uring.h"
 #include "nancy/net/socket.h"
+#include "nancy/details/queue.h"
+#include "nancy/details/thread_pool.h"
 #include "nancy/details/type_traits.h"
 
 namespace nc::net {  
@@ -26,72 +43,999 @@ namespace nc::net {
  * @note  配置文件在 ./details/config.h。事实上所做的配置并不需要多做更改
 */
 class reactor {
-    bool stop = false;
-    int epoll_fd = 0;
-    int signal_fd = 0;
+    // 文件描述符上下文，以fd为下标直接索引
+    struct fd_context {
+        event_t interest = event::null;  // 当前注册到epoll的事件（含触发模式）
+        uint32_t seq = 0;                // 注册序号，每次(重新)注册或移除时递增，用于丢弃过期的完成事件
+        uint32_t generation = 0;         // fd代数，每次注册或移除时递增，与fd组成连接句柄
+        uint8_t op = 0;                  // io_uring上挂起的请求类型
+        bool requeued = false;           // 已在就绪列表中
+        socket_callback_t cb = {};       // 私有回调，为空时使用公共回调
+        receive_callback_t recv_cb = {}; // receiver的数据回调
+        datagram_callback_t dgram_cb = {};  // 数据报接收者的回调
+        std::unique_ptr<connection> conn = {nullptr};  // 由反应堆管理的连接
+    };
+
+    // recvmmsg使用的缓冲区与消息头，在添加第一个数据报接收者时分配
+    struct datagram_pool {
+        std::unique_ptr<char[]> bufs;
+        struct mmsghdr msgs[config::udp_batch];
+        struct iovec iovs[config::udp_batch];
+        struct sockaddr_in addrs[config::udp_batch];
+        char control[config::udp_batch][CMSG_SPACE(sizeof(int))];
+
+        datagram_pool()
+            : bufs(new char[config::udp_batch * config::udp_buf_size]) {
+            memset(msgs, 0, sizeof(msgs));
+            for (int i = 0; i < config::udp_batch; ++i) {
+                iovs[i].iov_base = bufs.get() + i * config::udp_buf_size;
+            }
+        }
+    };
+
+    // io_uring请求类型，编码在user_data的高8位
+    static const uint8_t op_null = 0;
+    static const uint8_t op_poll = 1;
+    static const uint8_t op_accept = 2;
+    static const uint8_t op_recv = 3;
+    static const uint8_t op_cancel = 4;
+
+    std::atomic<bool> stop = {false};
+    int epoll_fd = -1;
+    int signal_fd = -1;
+    sigset_t signal_mask;
+    int wakeup_fd = 0;
     int timeout = -1;
 
     std::unique_ptr<epoll_event[]> events = {nullptr};
+    int event_cap = config::min_events;               // 事件数组的当前长度，随每轮返回的事件数自适应
+    int shrink_rounds = 0;                            // 事件数组连续偏空的轮数
+    std::chrono::microseconds busy_poll = std::chrono::microseconds(0);  // 有事件后继续以0超时轮询的时长
+    size_t zerocopy_threshold = config::zerocopy_threshold;
+    std::unique_ptr<uring> ring = {nullptr};          // 非空时使用io_uring后端
+    std::unique_ptr<char[]> recv_buf = {nullptr};     // epoll后端receiver的接收缓冲区
+    std::unique_ptr<datagram_pool> dgram_pool = {nullptr};  // 数据报接收者共用的recvmmsg缓冲区
     socket_callback_t readable_cb = {};
     socket_callback_t writable_cb = {};
     socket_callback_t disconnect_cb = {};
     callback_t timeout_cb = {};
-    std::unordered_map<int, socket_callback_t> cb_list = {};
-    std::map<int, socket_callback_t> signal_cbs = {};
+    timer_queue timers = {};
+    timing_wheel wheel = timing_wheel(config::wheel_slots);  // 连接的空闲/发送超时
+    timer_id wheel_timer = 0;                                 // 推进时间轮的周期任务，轮为空时取消
+    timer_queue::timestamp_t wheel_origin = timer_queue::clock_t::now();
+    uint32_t idle_ticks = 0;                                  // 新连接默认的空闲超时(刻度)
+    uint32_t write_ticks = 0;                                 // 新连接默认的发送超时(刻度)
+    loop_recorder stats;
+    std::deque<fd_context> fd_table = {};  // deque扩容时不会使已有元素的引用失效，回调中可安全添加fd
+    std::map<int, signal_callback_t> signal_cbs = {};
+    std::vector<std::unique_ptr<connection>> closed_conns = {};  // 本轮循环中关闭的连接，在循环末尾释放
+    bool cork = false;                                         // 合并本轮循环中的写入，在循环末尾统一发送
+    size_t read_budget = 0;                                    // 每次可读事件最多读取的字节数，0为不限
+    std::vector<int> ready_list = {};                          // 读取预算耗尽、等待再次分发的fd
+    std::vector<int> ready_running = {};
+    std::vector<connection*> corked_conns = {};
+    std::vector<connection*> flushing_conns = {};
+
+    // 等待在本轮循环末尾摘下的连接
+    struct pending_detach {
+        connection* conn;
+        handle_t h;
+        std::function<void(std::unique_ptr<connection>)> cb;
+    };
+    std::vector<pending_detach> detaching_conns = {};
+
+    // 跨线程任务
+    std::atomic<bool> wakeup_pending = {false};
+    std::atomic<std::thread::id> loop_thread = {std::thread::id()};
+    nc::details::mpsc_queue<callback_t> tasks;
 
 public:
-    explicit reactor(int timeout = -1) {
-        assert((epoll_fd = epoll_create(30)) != -1);
-        events.reset(new epoll_event[1024]);
+    /**
+     * @param timeout 超时时间(毫秒)，-1为不超时
+     * @param engine  IO后端，默认为epoll，可选backend::uring
+     */
+    explicit reactor(int timeout = -1, backend_t engine = backend::epoll) {
+        if (engine == backend::uring) {
+            ring.reset(new uring(config::uring_entries));
+        } else {
+            assert((epoll_fd = epoll_create(30)) != -1);
+            events.reset(new epoll_event[event_cap]);
+        }
         this->timeout = timeout;
+        sigemptyset(&signal_mask);
+        if (-1 == (wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))) {
+            throw std::runtime_error(std::string("Nancy-reactor: ")+strerror(errno));
+        }
+        epoll_add(wakeup_fd, event::readable, pattern::lt);
+        context(wakeup_fd).cb = [this](int) { deal_tasks(); };
     }
     ~reactor() noexcept {
         destroy();
+        for (auto& ctx : fd_table) {
+            if (ctx.conn) {
+                close(ctx.conn->get_fd());
+                release_zerocopy(ctx.conn.get());
+            }
+        }
+        if (ring) {
+            ring->cancel_all();
+        }
+        if (epoll_fd != -1) {
+            close(epoll_fd);
+        }
+        if (signal_fd != -1) {
+            close(signal_fd);
+        }
+        close(wakeup_fd);
     }
 
 private:
+    // 获取fd对应的上下文，必要时扩充表
+    fd_context& context(int fd) {
+        assert(fd >= 0);
+        if (static_cast<size_t>(fd) >= fd_table.size()) {
+            fd_table.resize(fd + 1);
+        }
+        return fd_table[fd];
+    }
+
     void epoll_add(int sock, event_t ev, pattern_t pattern) {
         struct epoll_event event;
         event.data.fd = sock;
         event.events = ev | pattern | event::disconnect;
+        auto& ctx = context(sock);
+        next_generation(ctx);
+        if (ring) {
+            uring_cancel(sock, ctx);  // fd号被复用时旧请求可能仍挂起
+            ctx.interest = event.events;
+            uring_arm(sock, ctx, op_poll);
+            return;
+        }
         if (-1 == epoll_ctl(epoll_fd, EPOLL_CTL_ADD, sock, &event)) {
             throw std::runtime_error(std::string("Nancy-reactor: ")+strerror(errno));
         }
+        ctx.interest = event.events;
     }
 
     void epoll_mod(int sock, event_t ev, pattern_t pattern) {
         struct epoll_event event;
         event.data.fd = sock;
         event.events = ev | pattern | event::disconnect;
+        auto& ctx = context(sock);
+        // 兴趣集未变化时跳过系统调用；oneshot模式触发后需要重新激活，不能跳过
+        if (ctx.interest == event.events && !(pattern & EPOLLONESHOT)) {
+            return;
+        }
+        stats.interest_update();
+        if (ring) {
+            uring_cancel(sock, ctx);
+            ctx.interest = event.events;
+            uring_arm(sock, ctx, op_poll);
+            return;
+        }
+        if (-1 == epoll_ctl(epoll_fd, EPOLL_CTL_MOD, sock, &event)) {
+            throw std::runtime_error(std::string("Nancy-reactor: ")+strerror(errno));
+        }
+        ctx.interest = event.events;
+    }
+
+    /**
+     * @brief 以新的兴趣集重新激活已注册的fd
+     * @return fd在被关闭前未经remove_socket移除、其号码又被新的fd复用时，残留的上下文已失效(内核中已不存在该注册)，
+     *         此时清理上下文并返回false，由调用者重新添加
+     */
+    bool epoll_rearm(int sock, event_t ev, pattern_t pattern) {
+        if (ring) {
+            epoll_mod(sock, ev, pattern);
+            return true;
+        }
+        struct epoll_event event;
+        event.data.fd = sock;
+        event.events = ev | pattern | event::disconnect;
+        stats.interest_update();
         if (-1 == epoll_ctl(epoll_fd, EPOLL_CTL_MOD, sock, &event)) {
+            if (errno == ENOENT) {
+                clear_context(sock);
+                return false;
+            }
+            throw std::runtime_error(std::string("Nancy-reactor: ")+strerror(errno));
+        }
+        context(sock).interest = event.events;
+        return true;
+    }
+
+    void epoll_del(int sock) {
+        if (ring) {
+            uring_cancel(sock, context(sock));
+            return;
+        }
+        if (-1 == epoll_ctl(epoll_fd, EPOLL_CTL_DEL, sock, nullptr)) {
+            throw std::runtime_error(std::string("Nancy-reactor: ")+strerror(errno));
+        }
+    }
+
+    // 递增fd代数，使此前的句柄失效；跳过0以保证句柄不为handle::null
+    static void next_generation(fd_context& ctx) {
+        if (++ctx.generation == 0) {
+            ctx.generation = 1;
+        }
+    }
+
+    // fd被关闭或移除后清理上下文，序号与代数递增使挂起的完成事件与旧句柄失效
+    void clear_context(int fd) {
+        if (static_cast<size_t>(fd) < fd_table.size()) {
+            auto& ctx = fd_table[fd];
+            if (ring) {
+                uring_cancel(fd, ctx);
+            }
+            if (ctx.conn) {
+                ctx.conn->closed = true;
+                closed_conns.push_back(std::move(ctx.conn));
+                stats.connection_closed();
+            }
+            uint32_t seq = ctx.seq + 1;
+            uint32_t generation = ctx.generation;
+            ctx = fd_context();
+            ctx.seq = seq;
+            ctx.generation = generation;
+            next_generation(ctx);
+        }
+    }
+
+    // =========================== io_uring ===========================
+
+    static uint64_t uring_data(uint8_t op, uint32_t seq, int fd) {
+        return (static_cast<uint64_t>(op) << 56) | (static_cast<uint64_t>(seq & 0xffffff) << 32) |
+               static_cast<uint32_t>(fd);
+    }
+
+    // 在io_uring上为fd挂起一个请求，请求在下一次等待时随其它请求批量提交
+    void uring_arm(int fd, fd_context& ctx, uint8_t op) {
+        io_uring_sqe* sqe = ring->get_sqe();
+        sqe->fd = fd;
+        if (op == op_poll) {
+            sqe->opcode = IORING_OP_POLL_ADD;
+            sqe->poll32_events = ctx.interest & ~(EPOLLET | EPOLLONESHOT);
+            // ET使用multishot poll；LT和oneshot使用单次poll，由反应堆在回调后重新挂起
+            if ((ctx.interest & EPOLLET) && !(ctx.interest & EPOLLONESHOT)) {
+                sqe->len = IORING_POLL_ADD_MULTI;
+            }
+        } else if (op == op_accept) {
+            sqe->opcode = IORING_OP_ACCEPT;
+            sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+            sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+        } else {
+            sqe->opcode = IORING_OP_RECV;
+            sqe->ioprio = IORING_RECV_MULTISHOT;
+            sqe->flags = IOSQE_BUFFER_SELECT;
+            sqe->buf_group = uring::buf_group;
+        }
+        ctx.seq = (ctx.seq + 1) & 0xffffff;
+        ctx.op = op;
+        sqe->user_data = uring_data(op, ctx.seq, fd);
+    }
+
+    // 取消fd上挂起的请求
+    void uring_cancel(int fd, fd_context& ctx) {
+        if (ctx.op == op_null) {
+            return;
+        }
+        io_uring_sqe* sqe = ring->get_sqe();
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->fd = -1;
+        sqe->addr = uring_data(ctx.op, ctx.seq, fd);
+        sqe->user_data = uring_data(op_cancel, 0, fd);
+        ctx.op = op_null;
+        ctx.seq = (ctx.seq + 1) & 0xffffff;
+    }
+
+    // 提交挂起的请求并等待，随后处理完成事件，返回处理的事件数
+    int uring_poll(int wait) {
+        ring->submit_and_wait(wait);
+        int nums = 0;
+        io_uring_cqe cqe;
+        auto start = timer_queue::clock_t::now();
+        while (nums < config::max_events && ring->peek(cqe)) {
+            callback_kind_t kind = deal_completion(cqe);
+            ++nums;
+            if (kind >= 0) {
+                start = record_callback(kind, start);
+            }
+        }
+        return nums;
+    }
+
+    // 处理完成事件，返回执行的回调类型，未执行回调时返回-1
+    callback_kind_t deal_completion(const io_uring_cqe& cqe) {
+        uint8_t op = static_cast<uint8_t>(cqe.user_data >> 56);
+        uint32_t seq = static_cast<uint32_t>(cqe.user_data >> 32) & 0xffffff;
+        int fd = static_cast<int>(static_cast<uint32_t>(cqe.user_data));
+        bool has_buf = cqe.flags & IORING_CQE_F_BUFFER;
+        unsigned short bid = static_cast<unsigned short>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+        if (op == op_cancel) {
+            return -1;
+        }
+        auto& ctx = fd_table[fd];
+        if (ctx.seq != seq || ctx.op != op) {  // 已被取消或重新注册
+            if (has_buf) {
+                ring->recycle(bid);
+            }
+            return -1;
+        }
+        if (!(cqe.flags & IORING_CQE_F_MORE)) {
+            ctx.op = op_null;
+        }
+        if (cqe.res == -ECANCELED || cqe.res == -EBADF) {  // 用户已关闭fd
+            return -1;
+        }
+
+        if (op == op_poll) {
+            event_t ev = cqe.res < 0 ? static_cast<event_t>(EPOLLERR) : static_cast<event_t>(cqe.res);
+            dispatch(fd, ev);
+            if (ctx.seq != seq) {  // 回调中已重新注册或移除
+                return kind_of(fd, ev);
+            }
+            if ((ev & event::disconnect) && !ctx.conn && !ctx.dgram_cb) {
+                // 对端关闭后结束该fd的注册，避免poll请求持有已被用户关闭的文件；连接由deal_connection自行关闭，
+                // 数据报套接字的错误(如ECONNREFUSED)已由recvmmsg取走，继续接收
+                uring_cancel(fd, ctx);
+                ctx.interest = event::null;
+            } else if (ctx.op == op_null && !(ctx.interest & EPOLLONESHOT)) {
+                uring_arm(fd, ctx, op_poll);
+            }
+            return kind_of(fd, ev);
+        } else if (op == op_accept) {
+            if (cqe.res >= 0) {
+                ctx.cb(cqe.res);
+            }
+            if (ctx.seq == seq && ctx.op == op_null && cqe.res != -EINVAL) {
+                uring_arm(fd, ctx, op_accept);
+            }
+            return callback_kind::readable;
+        } else {
+            if (has_buf) {
+                ctx.recv_cb(fd, ring->buffer(bid), cqe.res);
+                ring->recycle(bid);
+            } else if (cqe.res != -ENOBUFS) {
+                ctx.recv_cb(fd, nullptr, cqe.res);  // 0: 对端关闭; <0: -errno
+            }
+            // 缓冲区耗尽或multishot被内核终止时重新挂起，对端关闭或出错时结束
+            if (ctx.seq == seq && ctx.op == op_null && (cqe.res > 0 || cqe.res == -ENOBUFS)) {
+                uring_arm(fd, ctx, op_recv);
+            }
+            return cqe.res > 0 ? callback_kind::readable : callback_kind::disconnect;
+        }
+    }
+
+    // epoll后端receiver：读取直到EAGAIN
+    void deal_receive(int fd) {
+        auto& ctx = fd_table[fd];
+        uint32_t seq = ctx.seq;
+        char* buf = recv_buf.get();
+        ssize_t bytes = 0;
+        size_t total = 0;
+        while (ctx.seq == seq) {
+            if (read_budget && total >= read_budget) {  // 预算耗尽，让出给其它连接
+                requeue(fd);
+                break;
+            }
+            bytes = recv(fd, buf, config::recv_buf_size, 0);
+            if (bytes > 0) {
+                total += bytes;
+                ctx.recv_cb(fd, buf, bytes);
+            } else if (bytes == 0) {
+                ctx.recv_cb(fd, nullptr, 0);
+                break;
+            } else if (errno == EINTR) {
+                continue;
+            } else {
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {  // 包括回调中已关闭fd(EBADF)
+                    ctx.recv_cb(fd, nullptr, -errno);
+                }
+                break;
+            }
+        }
+    }
+
+    // 以recvmmsg批量读取数据报，GRO合并的数据报按分段长度拆分后逐个回调
+    // 不足一批或出错时停止：挂起的套接字错误由失败的调用取走，其后的数据报由LT模式在下一轮再次通知
+    void deal_datagram(int fd) {
+        auto& ctx = fd_table[fd];
+        uint32_t seq = ctx.seq;
+        datagram_pool* pool = dgram_pool.get();
+        size_t total = 0;
+        while (ctx.seq == seq) {
+            if (read_budget && total >= read_budget) {  // 预算耗尽，让出给其它fd
+                break;
+            }
+            for (int i = 0; i < config::udp_batch; ++i) {
+                auto& hdr = pool->msgs[i].msg_hdr;
+                pool->iovs[i].iov_len = config::udp_buf_size;
+                hdr.msg_iov = &pool->iovs[i];
+                hdr.msg_iovlen = 1;
+                hdr.msg_name = &pool->addrs[i];
+                hdr.msg_namelen = sizeof(pool->addrs[i]);
+                hdr.msg_control = pool->control[i];
+                hdr.msg_controllen = sizeof(pool->control[i]);
+                hdr.msg_flags = 0;
+            }
+            int nums = recvmmsg(fd, pool->msgs, config::udp_batch, MSG_DONTWAIT, nullptr);
+            if (nums < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            for (int i = 0; i < nums && ctx.seq == seq; ++i) {
+                const char* data = static_cast<const char*>(pool->iovs[i].iov_base);
+                size_t len = pool->msgs[i].msg_len;
+                size_t segment = datagram_segment(&pool->msgs[i].msg_hdr);
+                if (!segment || segment > len) {
+                    segment = len;
+                }
+                total += len;
+                size_t offset = 0;
+                do {
+                    size_t n = len - offset < segment ? len - offset : segment;
+                    ctx.dgram_cb(fd, data + offset, n, pool->addrs[i]);
+                    offset += n;
+                } while (offset < len && ctx.seq == seq);
+            }
+            if (nums < config::udp_batch) {
+                break;
+            }
+        }
+    }
+
+    // 读取UDP_GRO控制信息中的分段长度，没有合并时返回0
+    static size_t datagram_segment(struct msghdr* hdr) {
+        for (cmsghdr* cm = CMSG_FIRSTHDR(hdr); cm; cm = CMSG_NXTHDR(hdr, cm)) {
+            if (cm->cmsg_level == SOL_UDP && cm->cmsg_type == UDP_GRO) {
+                int size = 0;
+                memcpy(&size, CMSG_DATA(cm), sizeof(size));
+                return size > 0 ? static_cast<size_t>(size) : 0;
+            }
+        }
+        return 0;
+    }
+
+    // 处理连接上的事件：读取到输入缓冲区后回调，发送输出缓冲区中剩余的数据
+    void deal_connection(int fd, fd_context& ctx, event_t ev) {
+        connection* conn = ctx.conn.get();
+        uint32_t seq = ctx.seq;
+        if ((ev & EPOLLERR) && !conn->zerocopy_pending.empty()) {  // 零拷贝完成通知位于错误队列
+            deal_zerocopy(conn);
+            if (ctx.seq != seq) {
+                return;
+            }
+        }
+        if (ev & (event::readable | event::disconnect)) {
+            int err = 0;
+            ssize_t bytes = 0;
+            do {
+                bytes = conn->in.read_fd(fd, &err);
+                if (bytes > 0) {
+                    conn->active_tick = wheel.now();  // 刷新空闲超时只需一次赋值
+                    conn->read_total += bytes;
+                }
+                if (bytes > 0 && conn->message_cb) {
+                    conn->dispatching = true;
+                    conn->message_cb(conn);
+                    conn->dispatching = false;  // 回调中不能摘下连接，关闭的连接在本轮末尾才释放
+                    if (ctx.seq != seq) {       // 回调中已关闭连接
+                        return;
+                    }
+                    if (conn->retired) {
+                        conn->retired = nullptr;
+                    }
+                }
+            } while (bytes > 0 && (ev & event::disconnect));  // 对端关闭时读尽剩余数据
+            if (bytes == 0 || (bytes < 0 && err != EAGAIN && err != EWOULDBLOCK && err != EINTR)) {
+                close_connection(conn);
+                return;
+            }
+        }
+        if ((ev & event::writable) && conn->pending_bytes()) {
+            flush_connection(conn);
+        }
+    }
+
+    // 读取错误队列中的零拷贝完成通知，释放内核已不再引用的用户缓冲区
+    void deal_zerocopy(connection* conn) {
+        char control[128];
+        for (;;) {
+            struct msghdr msg;
+            memset(&msg, 0, sizeof(msg));
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+            if (recvmsg(conn->fd, &msg, MSG_ERRQUEUE) < 0) {
+                break;
+            }
+            for (cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+                if (!(cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) &&
+                    !(cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR)) {
+                    continue;
+                }
+                auto* err = reinterpret_cast<sock_extended_err*>(CMSG_DATA(cm));
+                if (err->ee_errno != 0 || err->ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+                    continue;
+                }
+                if (err->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+                    conn->zerocopy = -1;  // 内核退化为复制(如回环地址)，此后直接复制更快
+                }
+                // 通知为闭区间[ee_info, ee_data]，通常按序到达，乱序时等待前面的发送完成后一并释放
+                for (auto& entry : conn->zerocopy_pending) {
+                    if (entry.id - err->ee_info <= err->ee_data - err->ee_info) {
+                        entry.done = true;
+                    }
+                }
+            }
+        }
+        while (!conn->zerocopy_pending.empty() && conn->zerocopy_pending.front().done) {
+            callback_t release = std::move(conn->zerocopy_pending.front().release);
+            conn->zerocopy_pending.pop_front();
+            release();
+        }
+    }
+
+    // 连接关闭时释放全部零拷贝缓冲区与文件区间，已发送的页面由内核自行持有引用
+    void release_zerocopy(connection* conn) {
+        std::deque<connection::zerocopy_entry> pending;
+        pending.swap(conn->zerocopy_pending);
+        for (auto& entry : pending) {
+            entry.release();
+        }
+        std::deque<connection::file_segment> files;
+        files.swap(conn->files);
+        conn->file_bytes = conn->file_preceding = 0;
+        for (auto& file : files) {
+            if (file.done) {
+                file.done();
+            }
+        }
+    }
+
+    // 为套接字开启SO_ZEROCOPY，不支持时返回false
+    bool enable_zerocopy(connection* conn) {
+        if (conn->zerocopy == 0) {
+            int one = 1;
+            conn->zerocopy = setsockopt(conn->fd, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) ? -1 : 1;
+        }
+        return conn->zerocopy > 0;
+    }
+
+    // 发送输出缓冲区中的数据，发送完毕后不再关注可写事件
+    void flush_connection(connection* conn) {
+        buffer& out = conn->out;
+        for (;;) {
+            // 先发送排在下一个文件之前的缓冲数据
+            size_t limit = conn->files.empty() ? out.readable_bytes() : conn->files.front().preceding;
+            if (limit) {
+                // 后面紧跟文件时以MSG_MORE提示内核与文件数据合并为完整的报文段
+                int flags = MSG_NOSIGNAL | (conn->files.empty() ? 0 : MSG_MORE);
+                ssize_t bytes = ::send(conn->fd, out.peek(), limit, flags);
+                if (bytes < 0) {
+                    if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                        close_connection(conn);
+                    }
+                    return;
+                }
+                out.retrieve(bytes);
+                if (!conn->files.empty()) {
+                    conn->files.front().preceding -= bytes;
+                    conn->file_preceding -= bytes;
+                }
+                if (static_cast<size_t>(bytes) < limit) {
+                    return;
+                }
+            }
+            if (conn->files.empty()) {
+                break;
+            }
+            if (!flush_file(conn)) {
+                return;
+            }
+        }
+        conn->write_since = 0;
+        epoll_mod(conn->fd, event::readable, pattern::lt);
+    }
+
+    // =========================== 连接超时 ===========================
+
+    static uint32_t to_ticks(int ms) {
+        return ms > 0 ? static_cast<uint32_t>((ms + config::wheel_tick_ms - 1) / config::wheel_tick_ms) : 0;
+    }
+
+    // 时间轮的目标刻度，由实际经过的时间计算
+    uint64_t wheel_target() const {
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(timer_queue::clock_t::now() - wheel_origin);
+        return 1 + elapsed.count() / config::wheel_tick_ms;
+    }
+
+    // 时间轮为空时推进任务已停止，重新开始前先将当前刻度追上实际时间
+    void start_wheel() {
+        if (wheel_timer) {
+            return;
+        }
+        wheel.skip_to(wheel_target());
+        wheel_timer = timers.add(config::wheel_tick_ms, config::wheel_tick_ms, [this] { advance_wheel(); });
+    }
+
+    // 按实际经过的时间推进时间轮，循环被阻塞时补齐错过的刻度
+    void advance_wheel() {
+        uint64_t target = wheel_target();
+        while (wheel.now() < target && !wheel.empty()) {
+            wheel.advance([this](handle_t h, uint64_t tick) { expire_connection(h, tick); });
+        }
+        if (wheel.empty()) {
+            timers.cancel(wheel_timer);
+            wheel_timer = 0;
+        }
+    }
+
+    // 连接最早的截止刻度，0为没有超时限制
+    static uint64_t connection_deadline(const connection* conn) {
+        uint64_t deadline = conn->idle_ticks ? conn->active_tick + conn->idle_ticks : 0;
+        if (conn->write_ticks && conn->write_since) {
+            uint64_t write = conn->write_since + conn->write_ticks;
+            deadline = deadline && deadline < write ? deadline : write;
+        }
+        return deadline;
+    }
+
+    // 截止刻度早于轮中已有的项时才重新放入，推迟的截止刻度在到期时再处理
+    void schedule_connection(connection* conn) {
+        uint64_t deadline = connection_deadline(conn);
+        if (!deadline || (conn->wheel_tick && conn->wheel_tick <= deadline)) {
+            return;
+        }
+        start_wheel();
+        wheel.add(conn->handle, deadline);
+        conn->wheel_tick = deadline;
+    }
+
+    // 时间轮中的项到期：连接已关闭或已被重新放入时丢弃，截止刻度被推迟时重新放入
+    void expire_connection(handle_t h, uint64_t tick) {
+        connection* conn = get_connection(h);
+        if (!conn || conn->wheel_tick != tick) {
+            return;
+        }
+        conn->wheel_tick = 0;
+        uint64_t deadline = connection_deadline(conn);
+        if (deadline && deadline <= wheel.now()) {
+            conn->timed_out = true;
+            close_connection(conn);
+        } else {
+            schedule_connection(conn);
+        }
+    }
+
+    // 输出开始积压时记录刻度，用于发送超时
+    void watch_output(connection* conn) {
+        if (conn->write_ticks && !conn->write_since && !conn->closed) {
+            conn->write_since = wheel.now();
+            schedule_connection(conn);
+        }
+    }
+
+    // 在线程池中执行任务，结果投递回反应堆线程交付
+    template <typename W, typename D>
+    void submit_offload(nc::details::work_stealing_pool& pool, handle_t h, uint64_t seq, W work, D done, std::false_type) {
+        pool.submit([this, h, seq, work, done]() mutable {
+            auto res = std::make_shared<decltype(work())>(work());
+            post(h, [this, h, seq, res, done] {
+                deliver_offload(h, seq, [res, done](connection* c) mutable { done(c, std::move(*res)); });
+            });
+        });
+    }
+
+    // 同上，任务没有结果
+    template <typename W, typename D>
+    void submit_offload(nc::details::work_stealing_pool& pool, handle_t h, uint64_t seq, W work, D done, std::true_type) {
+        pool.submit([this, h, seq, work, done]() mutable {
+            work();
+            post(h, [this, h, seq, done] { deliver_offload(h, seq, done); });
+        });
+    }
+
+    // 交付线程池任务的结果，序号之前的结果尚未交付时暂存
+    void deliver_offload(handle_t h, uint64_t seq, connection_callback_t&& deliver) {
+        connection* conn = get_connection(h);
+        if (!conn) {
+            return;
+        }
+        if (seq != conn->offload_delivered) {
+            conn->offload_ready.emplace(seq, std::move(deliver));
+            return;
+        }
+        deliver(conn);
+        ++conn->offload_delivered;
+        // 交付此前暂存的后续结果；回调中关闭连接时停止，连接对象在本轮循环末尾才释放
+        auto it = conn->offload_ready.begin();
+        while (!conn->closed && it != conn->offload_ready.end() && it->first == conn->offload_delivered) {
+            connection_callback_t next = std::move(it->second);
+            conn->offload_ready.erase(it);
+            next(conn);
+            ++conn->offload_delivered;
+            it = conn->offload_ready.begin();
+        }
+    }
+
+    // 以可读事件再次分发上一轮放入就绪列表的fd，返回分发的个数
+    int deal_ready() {
+        ready_running.swap(ready_list);  // 分发中再次requeue的fd留到下一轮
+        auto start = timer_queue::clock_t::now();
+        int nums = 0;
+        for (int fd : ready_running) {
+            auto& ctx = fd_table[fd];
+            if (!ctx.requeued) {  // 已被移除
+                continue;
+            }
+            ctx.requeued = false;
+            dispatch(fd, event::readable);
+            start = record_callback(callback_kind::readable, start);
+            ++nums;
+        }
+        ready_running.clear();
+        return nums;
+    }
+
+    // 将连接加入本轮循环末尾的发送列表
+    void cork_connection(connection* conn) {
+        if (!conn->corked) {
+            conn->corked = true;
+            corked_conns.push_back(conn);
+        }
+    }
+
+    // 连接在本轮中仍可摘下：未关闭，且没有仍引用其fd或回调的零拷贝发送、文件区间与线程池任务
+    static bool detachable(const connection* conn) noexcept {
+        return !conn->closed && conn->zerocopy_pending.empty() && conn->files.empty() && !conn->offload_inflight();
+    }
+
+    // 摘下本轮登记的连接，此时没有正在执行的回调
+    void deal_detaching() {
+        while (!detaching_conns.empty()) {
+            std::vector<pending_detach> batch;
+            batch.swap(detaching_conns);  // 回调中可能登记新的连接
+            for (auto& d : batch) {
+                std::unique_ptr<connection> res;
+                if (get_connection(d.h) == d.conn) {
+                    d.conn->detaching = false;
+                    res = detach_connection(d.conn);
+                }
+                d.cb(std::move(res));
+            }
+        }
+    }
+
+    // 循环末尾统一发送本轮合并的写入，每个连接至多一次系统调用（不含文件区间）
+    void flush_corked() {
+        while (!corked_conns.empty()) {
+            flushing_conns.swap(corked_conns);  // 发送中的回调可能产生新的写入
+            for (connection* conn : flushing_conns) {
+                conn->corked = false;
+                if (conn->closed || !conn->pending_bytes()) {
+                    continue;
+                }
+                flush_connection(conn);
+                if (!conn->closed && conn->pending_bytes()) {
+                    epoll_mod(conn->fd, event::readable | event::writable, pattern::lt);
+                }
+            }
+            flushing_conns.clear();
+        }
+    }
+
+    // 以sendfile/splice发送队首的文件区间，发送完毕返回true
+    bool flush_file(connection* conn) {
+        auto& file = conn->files.front();
+        while (file.remaining) {
+            ssize_t bytes = file.pipe
+                ? splice(file.fd, nullptr, conn->fd, nullptr, file.remaining, SPLICE_F_MOVE | SPLICE_F_NONBLOCK)
+                : sendfile(conn->fd, file.fd, &file.offset, file.remaining);
+            if (bytes > 0) {
+                file.remaining -= bytes;
+                conn->file_bytes -= bytes;
+            } else if (bytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+                return false;
+            } else {  // 出错或文件比声明的更短，对端已无法正确解析后续数据
+                close_connection(conn);
+                return false;
+            }
+        }
+        callback_t done = std::move(file.done);
+        conn->files.pop_front();
+        if (done) {
+            done();
+        }
+        return !conn->closed;
+    }
+
+    // 将事件分发给私有回调或公共回调
+    void dispatch(int fd, event_t ev) {
+        auto& ctx = fd_table[fd];
+        if (ctx.conn) {
+            deal_connection(fd, ctx, ev);
+        } else if (ctx.cb) {
+            ctx.cb(fd);
+        } else if (ev & event::disconnect) {
+            if (static_cast<bool>(disconnect_cb)) {
+                disconnect_cb(fd);
+            } else {
+                clear_context(fd);
+                close(fd);
+            }
+        } else if (ev & event::readable) {
+            readable_cb(fd);
+        } else if (ev & event::writable) {
+            writable_cb(fd);
+        }
+    }
+
+    // 根据本轮返回的事件数调整epoll事件数组的长度
+    void resize_events(int nums) {
+        int cap = event_cap;
+        if (nums == event_cap && event_cap < config::max_events) {
+            cap = event_cap * 2 < config::max_events ? event_cap * 2 : config::max_events;
+        } else if (nums < event_cap / 4 && event_cap > config::min_events) {
+            if (++shrink_rounds >= config::event_shrink_rounds) {
+                cap = event_cap / 2 > config::min_events ? event_cap / 2 : config::min_events;
+            }
+            if (cap == event_cap) {
+                return;
+            }
+        }
+        shrink_rounds = 0;
+        if (cap != event_cap) {
+            event_cap = cap;
+            events.reset(new epoll_event[event_cap]);
+        }
+    }
+
+    // 事件对应的回调类型
+    callback_kind_t kind_of(int fd, event_t ev) const noexcept {
+        if (fd == wakeup_fd) {
+            return callback_kind::task;
+        } else if (ev & event::disconnect) {
+            return callback_kind::disconnect;
+        }
+        return (ev & event::readable) ? callback_kind::readable : callback_kind::writable;
+    }
+
+    // 记录自start以来的回调耗时，返回当前时间作为下一个回调的起点
+    timer_queue::timestamp_t record_callback(callback_kind_t kind, timer_queue::timestamp_t start) {
+        auto now = timer_queue::clock_t::now();
+        stats.callback(kind, std::chrono::duration_cast<std::chrono::nanoseconds>(now - start).count());
+        return now;
+    }
+
+    // 等待并分发事件，返回事件数
+    int poll_events(int wait) {
+        int nums = 0;
+        if (ring) {
+            nums = uring_poll(wait);
+        } else {
+            nums = epoll_wait(epoll_fd, events.get(), event_cap, wait);
+            auto start = timer_queue::clock_t::now();
+            for (int i = 0; i < nums; i++) {
+                dispatch(events[i].data.fd, events[i].events);
+                start = record_callback(kind_of(events[i].data.fd, events[i].events), start);
+            }
+            resize_events(nums);
+        }
+        stats.wakeup(nums);
+        return nums;
+    }
+
+    // 执行到期的定时任务，记录其滞后与耗时
+    void expire_timers(timer_queue::timestamp_t now) {
+        if (timers.empty() || timers.earliest() > now) {
+            return;
+        }
+        stats.lag(std::chrono::duration_cast<std::chrono::microseconds>(now - timers.earliest()).count());
+        timers.expire(now);
+        record_callback(callback_kind::timer, now);
+    }
+
+    // 根据最近的定时任务与超时时间计算epoll_wait的等待时间
+    int next_wait(timer_queue::timestamp_t idle_since) {
+        if (timeout < 0 && timers.empty()) {
+            return -1;
+        }
+        auto now = timer_queue::clock_t::now();
+        int wait = timers.next_timeout(now);
+        if (timeout >= 0) {
+            int idle = timer_queue::millis_until(idle_since + std::chrono::milliseconds(timeout), now);
+            wait = (wait < 0 || idle < wait) ? idle : wait;
+        }
+        return wait;
+    }
+
+    // 唤醒反应堆，同一轮循环内的多次唤醒只写一次eventfd
+    void wakeup() {
+        if (!wakeup_pending.exchange(true, std::memory_order_acq_rel)) {
+            uint64_t one = 1;
+            if (write(wakeup_fd, &one, sizeof(one)) != sizeof(one)) {
+                wakeup_pending.store(false, std::memory_order_release);
+            }
+        }
+    }
+
+    // 执行其它线程投递的任务，此后投递的任务留待下一轮循环
+    void deal_tasks() {
+        uint64_t cnt = 0;
+        if (read(wakeup_fd, &cnt, sizeof(cnt)) != sizeof(cnt) && errno != EAGAIN) {
             throw std::runtime_error(std::string("Nancy-reactor: ")+strerror(errno));
         }
+        wakeup_pending.exchange(false, std::memory_order_acq_rel);
+        tasks.drain([](callback_t& task) { task(); });
     }
 
+    // 读取signalfd中的全部信号。标准信号在内核中合并，待处理期间多次到达只报告一次
     void deal_signal() {
-        int ret = 0;
-        const int buf_sz = 24;
-        char signals[buf_sz];
-        ret = read(signal_fd, signals, buf_sz);
-        for (int i = 0; i < ret; ++i) {
-            signal_cbs[signals[i]](signals[i]);
+        signalfd_siginfo infos[16];
+        ssize_t bytes = 0;
+        while ((bytes = read(signal_fd, infos, sizeof(infos))) > 0) {
+            int nums = static_cast<int>(bytes / sizeof(signalfd_siginfo));
+            for (int i = 0; i < nums; ++i) {
+                auto it = signal_cbs.find(static_cast<int>(infos[i].ssi_signo));
+                if (it != signal_cbs.end()) {
+                    it->second(infos[i]);
+                }
+            }
+            if (nums < 16) {
+                break;
+            }
         }
     }
 
-public:
-    // 注册信号
-    template <typename F,  typename = typename std::enable_if<nc::details::is_runnable<F, int>::value>::type>
-    void add_signal(int sig, F&& cb) {
-        int fd = signal_socket_init();
+    // 更新signalfd的信号集，首次调用时创建并注册
+    void update_signalfd() {
+        int fd = signalfd(signal_fd, &signal_mask, SFD_NONBLOCK | SFD_CLOEXEC);
         if (fd == -1) {
-            throw std::logic_error("Nancy-reactor: init signal handle twice");
-        } else {
+            throw std::runtime_error(std::string("Nancy-reactor: ")+strerror(errno));
+        }
+        if (signal_fd == -1) {
             signal_fd = fd;
             epoll_add(signal_fd, event::readable, pattern::lt);
+            context(signal_fd).cb = [this](int) { deal_signal(); };
         }
+    }
 
+public:
+    /**
+     * @brief 注册信号，由本反应堆的signalfd接收，回调在反应堆线程中执行
+     * @param sig 信号
+     * @param cb 回调void(const signalfd_siginfo&)，可获取发送者pid、sigqueue附带的值等信息
+     * @note 信号在调用线程中被屏蔽，此后创建的线程会继承屏蔽字；已存在的其它线程需自行调用signal_block，
+     *       否则信号可能被投递到这些线程而不经过signalfd
+     * @note 每个反应堆可以拥有不同的信号，同一信号只应由一个反应堆注册
+     */
+    template <typename F,  typename std::enable_if<nc::details::is_runnable<F, const signalfd_siginfo&>::value, int>::type = 0>
+    void add_signal(int sig, F&& cb) {
+        signal_block(sig);
+        sigaddset(&signal_mask, sig);
+        update_signalfd();
         signal_cbs[sig] = std::forward<F>(cb);
-        signal_add(sig);
+    }
+
+    // 同上，回调为void(int)，参数为信号值
+    template <typename F,  typename = typename std::enable_if<nc::details::is_runnable<F, int>::value>::type>
+    void add_signal(int sig, F&& cb) {
+        socket_callback_t sig_cb(std::forward<F>(cb));
+        add_signal(sig, [sig_cb](const signalfd_siginfo& info) { sig_cb(static_cast<int>(info.ssi_signo)); });
+    }
+
+    /**
+     * @brief 注销信号，信号在调用线程中保持屏蔽
+     * @param sig 信号
+     */
+    void remove_signal(int sig) {
+        if (signal_cbs.erase(sig)) {
+            sigdelset(&signal_mask, sig);
+            update_signalfd();
+        }
     }
 
     /**
@@ -102,6 +1046,7 @@ public:
      */
     void add_socket(int fd, event_t ev, pattern_t pattern) {
         epoll_add(fd, ev, pattern);
+        context(fd).cb = nullptr;
     }
 
     /**
@@ -114,19 +1059,657 @@ public:
      */
     template <typename F,  typename = typename std::enable_if<nc::details::is_runnable<F, int>::value>::type>
     void add_socket(int fd, event_t ev, pattern_t pattern, F&& cb) {
-        cb_list.emplace(fd, std::forward<F>(cb));
         epoll_add(fd, ev, pattern);
+        context(fd).cb = std::forward<F>(cb);
+    }
+
+    /**
+     * @brief 等待fd上的一次事件，触发后执行回调（oneshot模式），尚未注册的fd会被自动注册
+     * @param fd 文件描述符
+     * @param ev 事件
+     * @param cb 回调函数，事件或连接断开时调用一次
+     * @note 供协程等一次性等待的场景使用，fd不再使用时需要remove_socket
+     */
+    template <typename F,  typename = typename std::enable_if<nc::details::is_runnable<F, int>::value>::type>
+    void wait_event(int fd, event_t ev, F&& cb) {
+        if (!contains(fd) || !epoll_rearm(fd, ev, pattern::lt_oneshot)) {
+            epoll_add(fd, ev, pattern::lt_oneshot);
+        }
+        context(fd).cb = std::forward<F>(cb);
+    }
+
+    // fd是否已注册到反应堆中
+    bool contains(int fd) const noexcept {
+        return fd >= 0 && static_cast<size_t>(fd) < fd_table.size() && fd_table[fd].interest != event::null;
+    }
+
+    /**
+     * @brief 获取已注册fd当前的句柄
+     * @param fd 文件描述符
+     * @return 未注册时返回handle::null
+     * @note 句柄在fd被移除或关闭后失效，即使fd号随后被新的连接复用
+     */
+    handle_t get_handle(int fd) const noexcept {
+        return contains(fd) ? handle::make(fd, fd_table[fd].generation) : handle::null;
+    }
+
+    // 句柄对应的fd是否仍然注册在反应堆中，且未被移除或复用；仅在反应堆线程中调用
+    bool alive(handle_t h) const noexcept {
+        int fd = handle::fd_of(h);
+        return h != handle::null && contains(fd) && fd_table[fd].generation == handle::generation_of(h);
+    }
+
+    // 获取句柄对应的连接，句柄已失效或不属于连接时返回nullptr；仅在反应堆线程中调用
+    connection* get_connection(handle_t h) const noexcept {
+        if (!alive(h)) {
+            return nullptr;
+        }
+        connection* conn = fd_table[handle::fd_of(h)].conn.get();
+        return conn && !conn->closed ? conn : nullptr;
+    }
+
+    /**
+     * @brief 添加监听套接字，每接受一个连接调用一次回调
+     * @param fd 监听套接字
+     * @param cb 回调，参数为新连接的fd（已设置为非阻塞和CLOEXEC）
+     * @note io_uring后端使用multishot accept，epoll后端以LT模式每次最多accept4 config::accept_batch个连接
+     */
+    template <typename F,  typename = typename std::enable_if<nc::details::is_runnable<F, int>::value>::type>
+    void add_acceptor(int fd, F&& cb) {
+        if (ring) {
+            auto& ctx = context(fd);
+            uring_cancel(fd, ctx);
+            next_generation(ctx);
+            ctx.interest = event::readable;
+            ctx.cb = std::forward<F>(cb);
+            uring_arm(fd, ctx, op_accept);
+            return;
+        }
+        set_nonblocking(fd);
+        socket_callback_t conn_cb(std::forward<F>(cb));
+        epoll_add(fd, event::readable, pattern::lt);
+        context(fd).cb = [conn_cb](int fd) {
+            int conn = 0;
+            // LT模式，超出批量的连接在下一轮继续接受
+            for (int i = 0; i < config::accept_batch; ++i) {
+                if ((conn = accept4(fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) < 0) {
+                    if (errno == EINTR || errno == ECONNABORTED) {
+                        continue;
+                    }
+                    break;
+                }
+                conn_cb(conn);
+            }
+        };
+    }
+
+    /**
+     * @brief 添加数据接收者，数据到达时由反应堆读取并交给回调
+     * @param fd 非阻塞套接字
+     * @param cb 回调void(int fd, const char* data, ssize_t len)，len为0表示对端关闭，小于0为-errno
+     * @note io_uring后端使用multishot recv+provided buffer ring，epoll后端采用ET模式读取直到EAGAIN
+     * @note data只在回调期间有效；receiver不使用reset_event，需通过remove_socket移除
+     */
+    template <typename F,  typename = typename std::enable_if<
+                               nc::details::is_runnable<F, int, const char*, ssize_t>::value>::type>
+    void add_receiver(int fd, F&& cb) {
+        auto& ctx = context(fd);
+        if (ring) {
+            if (!ring->has_buffers()) {
+                ring->setup_buffers(config::uring_buf_nums, config::uring_buf_size);
+            }
+            uring_cancel(fd, ctx);
+            next_generation(ctx);
+            ctx.interest = event::readable;
+            ctx.cb = nullptr;
+            ctx.recv_cb = std::forward<F>(cb);
+            uring_arm(fd, ctx, op_recv);
+            return;
+        }
+        if (!recv_buf) {
+            recv_buf.reset(new char[config::recv_buf_size]);
+        }
+        epoll_add(fd, event::readable, pattern::et);
+        ctx.seq++;
+        ctx.recv_cb = std::forward<F>(cb);
+        ctx.cb = [this](int fd) { deal_receive(fd); };
+    }
+
+    /**
+     * @brief 添加数据报接收者，数据报到达时由反应堆以recvmmsg批量读取并逐个交给回调
+     * @param fd 非阻塞的UDP套接字，见udp_socket
+     * @param cb 回调void(int fd, const char* data, size_t len, const sockaddr_in& peer)
+     * @note 每次系统调用最多读取config::udp_batch个数据报，缓冲区由反应堆上的所有数据报接收者共用，data只在回调期间有效。
+     *       套接字开启UDP_GRO时，内核合并交付的数据报会被拆分为原来的数据报；读满预算(set_read_budget)后让出。
+     *       两种后端都以LT模式的可读事件驱动，已连接的套接字上挂起的错误(如ECONNREFUSED)不会使其后的数据报滞留，
+     *       需通过remove_socket移除
+     */
+    template <typename F,  typename = typename std::enable_if<
+                               nc::details::is_runnable<F, int, const char*, size_t, const struct sockaddr_in&>::value>::type>
+    void add_datagram_receiver(int fd, F&& cb) {
+        if (!dgram_pool) {
+            dgram_pool.reset(new datagram_pool());
+        }
+        epoll_add(fd, event::readable, pattern::lt);
+        auto& ctx = context(fd);
+        if (!ring) {
+            ctx.seq++;  // 中止fd上正在进行的读取循环；io_uring后端注册时已递增
+        }
+        ctx.dgram_cb = std::forward<F>(cb);
+        ctx.cb = [this](int fd) { deal_datagram(fd); };
+    }
+
+    /**
+     * @brief 发起非阻塞连接，由反应堆等待连接完成
+     * @param addr 对端地址
+     * @param timeout_ms 超时(毫秒)，0为不限
+     * @param cb 回调void(int fd, int err)，成功时fd为已连接的非阻塞套接字、err为0，之后可交给add_connection；
+     *           失败或超时时fd为-1，err为错误码(超时为ETIMEDOUT)，套接字已被关闭
+     * @note 仅在反应堆线程中调用；回调总是在本次调用返回之后执行，完成前不会阻塞反应堆
+     */
+    template <typename F,  typename = typename std::enable_if<nc::details::is_runnable<F, int, int>::value>::type>
+    void async_connect(const struct sockaddr_in& addr, int timeout_ms, F&& cb) {
+        std::function<void(int, int)> done(std::forward<F>(cb));
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        int err = fd == -1 ? errno : 0;
+        if (fd != -1 && -1 == connect(fd, (const struct sockaddr*)&addr, sizeof(addr))) {
+            err = errno;
+        }
+        if (err != EINPROGRESS) {  // 立即完成或失败
+            if (fd != -1 && err) {
+                close(fd);
+                fd = -1;
+            }
+            post([done, fd, err] { done(fd, err); });
+            return;
+        }
+        // 新建的套接字不可能已注册；同号fd若曾被直接关闭而未移除，清理其残留的上下文
+        clear_context(fd);
+        epoll_add(fd, event::writable, pattern::lt_oneshot);
+        context(fd).cb = [this, done](int fd) {
+            reactor* self = this;
+            std::function<void(int, int)> finish = done;  // 移除fd时本回调随上下文析构，先复制捕获的状态
+            int err = get_connect_error(fd);
+            self->remove_socket(fd);  // 代数递增，超时任务随之失效
+            if (err) {
+                close(fd);
+                fd = -1;
+            }
+            finish(fd, err);
+        };
+        if (timeout_ms > 0) {
+            run_after(get_handle(fd), timeout_ms, [this, done, fd] {
+                remove_socket(fd);
+                close(fd);
+                done(-1, ETIMEDOUT);
+            });
+        }
+    }
+
+    /**
+     * @brief 同上
+     * @param ip 对端ip
+     * @param port 对端端口
+     */
+    template <typename F,  typename = typename std::enable_if<nc::details::is_runnable<F, int, int>::value>::type>
+    void async_connect(const char* ip, int port, int timeout_ms, F&& cb) {
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        inet_pton(AF_INET, ip, &addr.sin_addr);
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        async_connect(addr, timeout_ms, std::forward<F>(cb));
+    }
+
+    /**
+     * @brief 将已连接的套接字交给反应堆管理
+     * @param fd 非阻塞套接字，此后由连接对象负责关闭
+     * @param cb 消息回调void(connection*)，每次有新数据读入输入缓冲区时调用
+     * @return 连接对象，在连接关闭前有效
+     * @note 连接采用LT模式，只有输出缓冲区中有待发送数据时才关注可写事件
+     */
+    template <typename F,  typename = typename std::enable_if<nc::details::is_runnable<F, connection*>::value>::type>
+    connection* add_connection(int fd, F&& cb) {
+        epoll_add(fd, event::readable, pattern::lt);
+        auto& ctx = context(fd);
+        ctx.cb = nullptr;
+        ctx.conn.reset(new connection(fd, handle::make(fd, ctx.generation)));
+        ctx.conn->owner = this;
+        ctx.conn->message_cb = std::forward<F>(cb);
+        stats.connection_opened();
+        if (idle_ticks || write_ticks) {
+            start_wheel();
+            ctx.conn->idle_ticks = idle_ticks;
+            ctx.conn->write_ticks = write_ticks;
+            ctx.conn->active_tick = wheel.now();
+            schedule_connection(ctx.conn.get());
+        }
+        return ctx.conn.get();
+    }
+
+    /**
+     * @brief 向连接发送数据，未能立即发送的部分追加到输出缓冲区，并开始关注可写事件
+     * @param conn 连接
+     * @param data 数据
+     * @param len 字节数
+     */
+    void send(connection* conn, const char* data, size_t len) {
+        struct iovec iov;
+        iov.iov_base = const_cast<char*>(data);
+        iov.iov_len = len;
+        send(conn, &iov, 1);
+    }
+
+    /**
+     * @brief 同上，以writev的方式一次发送多段数据
+     * @param conn 连接
+     * @param iov 数据段
+     * @param iovcnt 段数
+     */
+    void send(connection* conn, const struct iovec* iov, int iovcnt) {
+        if (conn->closed) {
+            return;
+        }
+        size_t total = 0;
+        for (int i = 0; i < iovcnt; ++i) {
+            total += iov[i].iov_len;
+        }
+        ssize_t bytes = 0;
+        bool idle = !conn->pending_bytes();
+        if (idle && !cork) {  // 没有待发送数据时直接发送
+            struct msghdr msg;
+            memset(&msg, 0, sizeof(msg));
+            msg.msg_iov = const_cast<struct iovec*>(iov);
+            msg.msg_iovlen = iovcnt;
+            bytes = ::sendmsg(conn->fd, &msg, MSG_NOSIGNAL);
+            if (bytes < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                    close_connection(conn);
+                    return;
+                }
+                bytes = 0;
+            }
+        }
+        if (static_cast<size_t>(bytes) == total) {
+            return;
+        }
+        for (int i = 0; i < iovcnt; ++i) {
+            size_t len = iov[i].iov_len;
+            if (static_cast<size_t>(bytes) >= len) {
+                bytes -= len;
+                continue;
+            }
+            conn->out.append(static_cast<const char*>(iov[i].iov_base) + bytes, len - bytes);
+            bytes = 0;
+        }
+        watch_output(conn);
+        if (cork && (idle || conn->corked)) {  // 本轮已合并的连接在循环末尾一并发送
+            cork_connection(conn);
+        } else {
+            epoll_mod(conn->fd, event::readable | event::writable, pattern::lt);
+        }
+    }
+
+    /**
+     * @brief 以MSG_ZEROCOPY发送用户缓冲区，内核不再引用该缓冲区时调用release
+     * @param conn 连接
+     * @param data 数据，在release被调用前不能修改或释放
+     * @param len 字节数，小于零拷贝阈值时直接复制发送并立即release
+     * @param release 释放回调void()，在反应堆线程中调用
+     * @note 输出缓冲区非空、套接字不支持SO_ZEROCOPY或内核已退化为复制时同样复制发送；未能立即发送的部分复制到输出缓冲区
+     * @note 连接关闭时所有未完成的release会被立即调用
+     */
+    template <typename F,  typename = typename std::enable_if<nc::details::is_runnable<F>::value>::type>
+    void send_zerocopy(connection* conn, const char* data, size_t len, F&& release) {
+        ssize_t bytes = 0;
+        if (!conn->closed && len >= zerocopy_threshold && !conn->pending_bytes() && enable_zerocopy(conn)) {
+            bytes = ::send(conn->fd, data, len, MSG_ZEROCOPY | MSG_NOSIGNAL);
+            if (bytes < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR && errno != ENOBUFS) {
+                close_connection(conn);
+                release();
+                return;
+            }
+        }
+        if (bytes <= 0) {  // 复制发送
+            send(conn, data, len);
+            release();
+            return;
+        }
+        conn->zerocopy_pending.push_back(connection::zerocopy_entry{conn->zerocopy_next++, false, callback_t(std::forward<F>(release))});
+        if (static_cast<size_t>(bytes) < len) {
+            conn->out.append(data + bytes, len - bytes);
+            watch_output(conn);
+            epoll_mod(conn->fd, event::readable | event::writable, pattern::lt);
+        }
+    }
+
+    /**
+     * @brief 由内核直接将文件区间发送到连接，数据不经过用户空间
+     * @param conn 连接
+     * @param file_fd 普通文件或块设备(sendfile)，或已写入数据的管道(splice，忽略offset)
+     * @param offset 文件偏移，不改变file_fd的读写位置
+     * @param len 字节数
+     * @param done 完成回调void()，文件区间发送完毕或连接关闭时调用，可在其中关闭file_fd
+     * @return file_fd类型不受支持或连接已关闭时返回false，此时不会调用done
+     * @note 与send/send_zerocopy的数据保持先后顺序；套接字发送缓冲区满时在可写事件中继续发送
+     */
+    template <typename F,  typename = typename std::enable_if<nc::details::is_runnable<F>::value>::type>
+    bool send_file(connection* conn, int file_fd, off_t offset, size_t len, F&& done) {
+        struct stat st;
+        if (conn->closed || fstat(file_fd, &st) == -1) {
+            return false;
+        }
+        bool pipe = S_ISFIFO(st.st_mode);
+        if (!pipe && !S_ISREG(st.st_mode) && !S_ISBLK(st.st_mode)) {
+            return false;
+        }
+        bool idle = !conn->pending_bytes();
+        size_t preceding = conn->out.readable_bytes() - conn->file_preceding;
+        conn->files.push_back(connection::file_segment{file_fd, offset, len, preceding, pipe, callback_t(std::forward<F>(done))});
+        conn->file_preceding += preceding;
+        conn->file_bytes += len;
+        watch_output(conn);
+        if (idle && cork) {
+            cork_connection(conn);
+        } else if (idle) {  // 没有待发送数据时直接发送，未发完再关注可写事件
+            flush_connection(conn);
+            if (!conn->closed && conn->pending_bytes()) {
+                epoll_mod(conn->fd, event::readable | event::writable, pattern::lt);
+            }
+        }
+        return true;
+    }
+
+    // 同上，不需要完成回调
+    bool send_file(connection* conn, int file_fd, off_t offset, size_t len) {
+        return send_file(conn, file_fd, offset, len, callback_t());
+    }
+
+    /**
+     * @brief 设置每次可读事件的读取预算
+     * @param bytes 字节数，0为不限(默认)
+     * @note receiver在读满预算后自动让出；自定义的ET回调可通过get_read_budget读取预算，读满后调用requeue
+     */
+    void set_read_budget(size_t bytes) {
+        read_budget = bytes;
+    }
+
+    size_t get_read_budget() const noexcept {
+        return read_budget;
+    }
+
+    /**
+     * @brief 将fd放入就绪列表，下一轮循环不必等待epoll事件即以可读事件再次分发
+     * @param fd 已注册的文件描述符
+     * @note 用于ET模式下读满预算但数据尚未读完的fd，使同一节点上的其它连接得到及时处理，避免单个快速发送方独占反应堆。
+     *       就绪列表非空时反应堆以0超时轮询新事件，然后按放入顺序分发就绪列表
+     */
+    void requeue(int fd) {
+        auto& ctx = context(fd);
+        if (!ctx.requeued) {
+            ctx.requeued = true;
+            ready_list.push_back(fd);
+        }
+    }
+
+    /**
+     * @brief 开启/关闭写合并：本轮循环中对同一连接的send/send_file只追加到输出缓冲区，在循环末尾统一发送
+     * @param on 是否开启，默认关闭
+     * @note 适用于一轮循环中多个回调向同一连接写入小消息的场景，可显著减少系统调用与TCP报文段。
+     *       数据的发送会推迟到本轮回调全部执行之后
+     */
+    void set_cork(bool on) {
+        cork = on;
+    }
+
+    // 设置零拷贝发送的最小字节数，默认为config::zerocopy_threshold
+    void set_zerocopy_threshold(size_t bytes) {
+        zerocopy_threshold = bytes;
+    }
+
+    /**
+     * @brief 通过句柄向连接发送数据，见send(connection*, const char*, size_t)
+     * @param h 连接句柄
+     * @return 连接已关闭或fd已被复用时返回false，数据被丢弃
+     * @note 仅在反应堆线程中调用；其它线程的异步应答应通过post(handle_t, F)投递
+     */
+    bool send(handle_t h, const char* data, size_t len) {
+        connection* conn = get_connection(h);
+        if (!conn) {
+            return false;
+        }
+        send(conn, data, len);
+        return true;
+    }
+
+    /**
+     * @brief 设置此后加入的连接默认的空闲超时与发送超时，见set_idle_timeout和set_write_timeout
+     * @param idle_ms 空闲超时(毫秒)，0为不限(默认)
+     * @param write_ms 发送超时(毫秒)，0为不限(默认)
+     */
+    void set_conn_timeout(int idle_ms, int write_ms) {
+        idle_ticks = to_ticks(idle_ms);
+        write_ticks = to_ticks(write_ms);
+    }
+
+    /**
+     * @brief 设置连接的空闲超时：超过ms毫秒没有读到数据时关闭连接
+     * @param conn 连接
+     * @param ms 超时(毫秒)，0为取消；精度为config::wheel_tick_ms
+     * @note 超时由时间轮管理，每次读到数据只需记录当前刻度，不产生额外的系统调用或容器操作。
+     *       超时关闭时同样调用关闭回调，可通过connection::is_timeout区分
+     */
+    void set_idle_timeout(connection* conn, int ms) {
+        if (conn->closed) {
+            return;
+        }
+        start_wheel();
+        conn->idle_ticks = to_ticks(ms);
+        conn->active_tick = wheel.now();
+        schedule_connection(conn);
+    }
+
+    /**
+     * @brief 设置连接的发送超时：待发送数据积压超过ms毫秒仍未发送完毕时关闭连接
+     * @param conn 连接
+     * @param ms 超时(毫秒)，0为取消；从输出开始积压时计时，全部发送完毕后重新计时
+     */
+    void set_write_timeout(connection* conn, int ms) {
+        if (conn->closed) {
+            return;
+        }
+        conn->write_ticks = to_ticks(ms);
+        if (conn->pending_bytes() && !conn->write_since) {
+            start_wheel();
+            conn->write_since = wheel.now();
+        }
+        schedule_connection(conn);
+    }
+
+    /**
+     * @brief 关闭连接，丢弃输出缓冲区中未发送的数据
+     * @param conn 连接，关闭后在本轮循环结束时释放
+     * @note 可重入，关闭回调只会执行一次
+     */
+    void close_connection(connection* conn) {
+        if (conn->closed) {
+            return;
+        }
+        int fd = conn->fd;
+        conn->closed = true;
+        if (conn->close_cb) {
+            conn->close_cb(conn);
+        }
+        clear_context(fd);
+        close(fd);
+        release_zerocopy(conn);
+    }
+
+    /**
+     * @brief 将连接连同回调、输入输出缓冲区与超时设置从反应堆中摘下，用于迁移到另一个反应堆(attach_connection)
+     * @param conn 连接，不能在其消息回调中调用，此时应使用detach_connection_later
+     * @return 连接对象；连接已关闭、正在执行消息回调，或有未完成的零拷贝发送、文件区间、线程池任务时不能迁移，返回nullptr
+     * @note 仅在反应堆线程中调用。摘下后旧句柄失效，与其绑定的任务和定时任务被丢弃；fd仍然打开，
+     *       期间到达的数据留在内核中，由新的反应堆读取
+     */
+    std::unique_ptr<connection> detach_connection(connection* conn) {
+        if (!detachable(conn) || conn->dispatching) {
+            return nullptr;
+        }
+        int fd = conn->fd;
+        if (conn->corked) {  // 待发送数据留在输出缓冲区，由新的反应堆发送
+            corked_conns.erase(std::remove(corked_conns.begin(), corked_conns.end(), conn), corked_conns.end());
+            conn->corked = false;
+        }
+        epoll_del(fd);
+        std::unique_ptr<connection> res(std::move(fd_table[fd].conn));
+        stats.connection_closed();
+        clear_context(fd);
+        res->handle = handle::null;
+        res->owner = nullptr;
+        res->wheel_tick = 0;  // 时间轮中的旧项随句柄失效
+        return res;
+    }
+
+    /**
+     * @brief 在本轮循环的回调全部返回后摘下连接，可以在其消息回调中调用
+     * @param conn 连接
+     * @param cb 回调void(std::unique_ptr<connection>)，在本轮循环末尾调用；连接在此之前已关闭或变为不能摘下时收到nullptr，
+     *           连接留在本反应堆
+     * @return 连接当前不能摘下(见detach_connection)或已登记时返回false，不会调用cb
+     * @note 仅在反应堆线程中调用；摘下前连接仍由本反应堆处理
+     */
+    template <typename F,  typename = typename std::enable_if<
+                               nc::details::is_runnable<F, std::unique_ptr<connection>>::value>::type>
+    bool detach_connection_later(connection* conn, F&& cb) {
+        if (!detachable(conn) || conn->detaching) {
+            return false;
+        }
+        conn->detaching = true;
+        detaching_conns.push_back(pending_detach{conn, conn->handle, std::forward<F>(cb)});
+        return true;
+    }
+
+    /**
+     * @brief 接管由另一个反应堆detach_connection摘下的连接
+     * @param conn 连接对象
+     * @return 连接，句柄已更新为本反应堆中的新句柄
+     * @note 仅在反应堆线程中调用；输入缓冲区中尚未消费的数据保留，在下一次读入新数据时随之回调
+     */
+    connection* attach_connection(std::unique_ptr<connection> conn) {
+        int fd = conn->fd;
+        epoll_add(fd, conn->pending_bytes() ? event::readable | event::writable : event::readable, pattern::lt);
+        auto& ctx = context(fd);
+        ctx.cb = nullptr;
+        conn->handle = handle::make(fd, ctx.generation);
+        conn->owner = this;
+        ctx.conn = std::move(conn);
+        stats.connection_opened();
+        connection* res = ctx.conn.get();
+        if (res->idle_ticks || res->write_ticks) {  // 刻度来自旧的时间轮，按迁入时刻重新计时
+            start_wheel();
+            res->active_tick = wheel.now();
+            res->write_since = res->pending_bytes() ? wheel.now() : 0;
+            schedule_connection(res);
+        }
+        return res;
+    }
+
+    /**
+     * @brief 遍历反应堆管理的所有连接
+     * @param f 回调void(connection*)，回调中不应添加或摘下连接
+     * @note 仅在反应堆线程中调用
+     */
+    template <typename F,  typename = typename std::enable_if<nc::details::is_runnable<F, connection*>::value>::type>
+    void for_each_connection(F&& f) {
+        for (auto& ctx : fd_table) {
+            if (ctx.conn && !ctx.conn->closed) {
+                f(ctx.conn.get());
+            }
+        }
+    }
+
+    /**
+     * @brief 从反应堆中移除文件描述符，但不关闭它
+     * @param fd 文件描述符
+     */
+    void remove_socket(int fd) {
+        epoll_del(fd);
+        clear_context(fd);
     }
 
     /**
      * @brief 更新套接字状态（在oneshot模式下使用）
      * @param sock  套接字
      * @param state 套接字状态
+     * @note  非oneshot模式下，若事件与当前注册的一致则不会产生系统调用
      */
     void reset_event(int for_whom, event_t event, pattern_t pattern) {
         epoll_mod(for_whom, event, pattern);
     }
 
+    /**
+     * @brief 投递任务到反应堆线程，在下一轮循环中执行
+     * @param task 任务
+     * @note 线程安全；同一轮循环内的多次投递只产生一次唤醒
+     */
+    template <typename F,  typename = typename std::enable_if<nc::details::is_runnable<F>::value>::type>
+    void post(F&& task) {
+        tasks.push(callback_t(std::forward<F>(task)));
+        wakeup();
+    }
+
+    /**
+     * @brief 投递与句柄绑定的任务，执行时句柄已失效则丢弃
+     * @param h 句柄，由get_handle或connection::get_handle获得
+     * @param task 任务
+     * @note 线程安全；校验只比较代数，不需要加锁或查找
+     */
+    template <typename F,  typename = typename std::enable_if<nc::details::is_runnable<F>::value>::type>
+    void post(handle_t h, F&& task) {
+        callback_t cb(std::forward<F>(task));
+        post([this, h, cb] {
+            if (alive(h)) {
+                cb();
+            }
+        });
+    }
+
+    /**
+     * @brief 将计算密集的任务交给线程池，结果在反应堆线程中按提交顺序交给连接
+     * @param pool 线程池，可由多个反应堆共用
+     * @param conn 连接
+     * @param work 在线程池中执行的任务，类型为R()；不应抛出异常
+     * @param done 结果回调，类型为void(connection*, R)，R为void时为void(connection*)；同一连接的结果按offload的调用顺序交付
+     * @note 仅在反应堆线程中调用；先完成的结果暂存在连接中，连接关闭后尚未交付的结果被丢弃
+     */
+    template <typename W, typename D, typename R = decltype(std::declval<W&>()()),
+              typename = typename std::enable_if<nc::details::is_result_runnable<D, R, connection*>::value>::type>
+    void offload(nc::details::work_stealing_pool& pool, connection* conn, W work, D done) {
+        handle_t h = conn->handle;
+        uint64_t seq = conn->offload_next++;
+        submit_offload(pool, h, seq, std::move(work), std::move(done), std::is_void<R>());
+    }
+
+    /**
+     * @brief 在反应堆线程中执行任务：若当前即为反应堆线程则立即执行，否则投递
+     * @param task 任务
+     * @note 线程安全
+     */
+    template <typename F,  typename = typename std::enable_if<nc::details::is_runnable<F>::value>::type>
+    void run_in_loop(F&& task) {
+        if (in_loop_thread()) {
+            task();
+        } else {
+            post(std::forward<F>(task));
+        }
+    }
+
+    // 当前线程是否为运行activate的线程
+    bool in_loop_thread() const {
+        return loop_thread.load(std::memory_order_relaxed) == std::this_thread::get_id();
+    }
+
     /**
      * @brief 重置超时时间
      * @param timeout 
@@ -158,6 +1741,56 @@ public:
         timeout_cb = std::forward<F>(cb);
     }
 
+    /**
+     * @brief 在ms毫秒后执行一次回调
+     * @param ms 延迟(毫秒)
+     * @param cb 回调函数
+     * @return 定时任务句柄，可用于cancel
+     * @note 定时任务在反应堆线程中执行，即使事件持续到来也能按时触发
+     */
+    template <typename F,  typename = typename std::enable_if<nc::details::is_runnable<F>::value>::type>
+    timer_id run_after(int ms, F&& cb) {
+        return timers.add(ms, 0, std::forward<F>(cb));
+    }
+
+    /**
+     * @brief 在ms毫秒后执行一次与句柄绑定的回调，届时句柄已失效则丢弃
+     * @param h 句柄
+     * @param ms 延迟(毫秒)
+     * @param cb 回调函数
+     * @return 定时任务句柄，可用于cancel
+     */
+    template <typename F,  typename = typename std::enable_if<nc::details::is_runnable<F>::value>::type>
+    timer_id run_after(handle_t h, int ms, F&& cb) {
+        callback_t task(std::forward<F>(cb));
+        return timers.add(ms, 0, [this, h, task] {
+            if (alive(h)) {
+                task();
+            }
+        });
+    }
+
+    /**
+     * @brief 每隔ms毫秒执行一次回调
+     * @param ms 周期(毫秒)，必须大于0
+     * @param cb 回调函数
+     * @return 定时任务句柄，可用于cancel
+     */
+    template <typename F,  typename = typename std::enable_if<nc::details::is_runnable<F>::value>::type>
+    timer_id run_every(int ms, F&& cb) {
+        assert(ms > 0);
+        return timers.add(ms, ms, std::forward<F>(cb));
+    }
+
+    /**
+     * @brief 取消定时任务，可在定时回调中取消自身
+     * @param id 定时任务句柄
+     * @return 任务存在且被取消时返回true
+     */
+    bool cancel(timer_id id) {
+        return timers.cancel(id);
+    }
+
     // 获取可读事件的回调函数的引用
     auto get_readable_cb() -> const socket_callback_t& {
         return readable_cb;
@@ -178,48 +1811,95 @@ public:
         return timeout_cb;
     }
 
+    /**
+     * @brief 设置混合轮询模式：有事件到来后的us微秒内以0超时轮询，之后再阻塞等待
+     * @param us 轮询时长(微秒)，0为关闭(默认)
+     * @note 以空闲时的少量CPU换取更低的唤醒延迟，适用于延迟敏感的服务。应在activate前或反应堆线程中调用
+     */
+    void set_busy_poll(int us) {
+        assert(us >= 0);
+        busy_poll = std::chrono::microseconds(us);
+    }
+
     /**
      * @brief 激活reactor，并阻塞所在线程
      */
     void activate() {
-        int fd = 0;
         int event_nums = 0;
-        decltype(cb_list)::iterator it(nullptr);
+        bool spinning = false;
+        auto idle_since = timer_queue::clock_t::now();
+        auto spin_until = idle_since;
+        loop_thread.store(std::this_thread::get_id(), std::memory_order_relaxed);
         while (!stop) {
-            event_nums = epoll_wait(epoll_fd, events.get(), 1024, timeout);
-            if (!event_nums) 
-                timeout_cb();
-            for (int i = 0; i < event_nums; i++) {
-                fd = events[i].data.fd;
-                if ((it = cb_list.find(fd)) != cb_list.end()) {
-                    it->second(fd);  
-                } else if (events[i].events & event::disconnect) {
-                    if (static_cast<bool>(disconnect_cb)) {
-                        disconnect_cb(fd);
-                    } else {
-                        close(fd);
+            event_nums = poll_events((spinning || !ready_list.empty()) ? 0 : next_wait(idle_since));
+            if (!ready_list.empty()) {
+                event_nums += deal_ready();
+            }
+            // 没有超时设置、定时任务与轮询模式时不读取时钟
+            bool busy = busy_poll.count() > 0;
+            spinning = false;  // 每轮重新判断，轮询模式在回调中被关闭时随即停止
+            if (busy || timeout >= 0 || !timers.empty()) {
+                auto now = timer_queue::clock_t::now();
+                if (busy) {
+                    if (event_nums > 0) {
+                        spin_until = now + busy_poll;
                     }
-                } else if (fd == signal_fd && (events[i].events & event::readable)) {
-                    deal_signal();
-                } else if (events[i].events & event::readable) {
-                    readable_cb(fd);
-                } else if (events[i].events & event::writable) {
-                    writable_cb(fd);
+                    spinning = now < spin_until;
                 }
+                if (event_nums > 0) {
+                    idle_since = now;
+                } else if (timeout >= 0 && now >= idle_since + std::chrono::milliseconds(timeout)) {
+                    idle_since = now;
+                    if (static_cast<bool>(timeout_cb)) {
+                        timeout_cb();
+                    }
+                }
+                expire_timers(now);
+            }
+            if (!detaching_conns.empty()) {
+                deal_detaching();
+            }
+            if (!corked_conns.empty()) {
+                flush_corked();
+            }
+            if (!closed_conns.empty()) {
+                closed_conns.clear();
             }
         }
     }
 
     /**
      * @brief 关闭反应堆
-     * @note 如果是同步关闭，则立刻执行，否则可能会延迟执行
+     * @note 线程安全。反应堆在本轮循环结束后退出，内核资源在析构时释放
      */
     void destroy() noexcept {
-        if (!stop) {
-            stop = true;
-            close(epoll_fd);
+        if (!stop.exchange(true)) {
+            wakeup();  // epoll/io_uring在析构时释放，避免本轮剩余的回调操作已关闭的描述符
         }
     }
+
+    /**
+     * @brief 获取循环指标的快照：唤醒次数、每次唤醒的事件数、各类回调的耗时分布与定时任务的滞后
+     * @note 线程安全且无锁，可在其它线程中周期性读取，通过两次快照的差值计算速率
+     */
+    loop_metrics metrics() const noexcept {
+        return stats.snapshot();
+    }
+
+    // 当前由反应堆管理的connection个数，线程安全且只有一次relaxed读取，供负载均衡使用
+    size_t connection_nums() const noexcept {
+        return stats.live_connections();
+    }
+
+    // 最近定时任务滞后的加权平均(微秒)，线程安全；没有定时任务时不更新
+    uint64_t recent_lag() const noexcept {
+        return stats.recent_lag();
+    }
+
+    // 获取IO后端类型
+    backend_t get_backend() const noexcept {
+        return ring ? backend::uring : backend::epoll;
+    }
 };
 
 
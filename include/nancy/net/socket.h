@@ -1,6 +1,8 @@
 #pragma once
 
 #include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -10,8 +12,16 @@
 #include <iostream>
 
 #include "nancy/net/fd.h"
+#include "nancy/net/details/config.h"
 #include "nancy/net/details/typedef.h"
 
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
 namespace nc::net {
 
 // 套接字基类
@@ -50,8 +60,9 @@ public:
      * @brief 监听连接请求
      * @param ip 地址
      * @param port 端口
+     * @param backlog 全连接队列长度，默认config::listen_backlog，内核会将其截断为net.core.somaxconn
      */
-    void listen_req(const char* ip, int port) {
+    void listen_req(const char* ip, int port, int backlog = config::listen_backlog) {
         struct sockaddr_in sock_addr;
         memset(&sock_addr, 0, sizeof(sock_addr));
         inet_pton(AF_INET, ip, &sock_addr.sin_addr);
@@ -61,7 +72,7 @@ public:
         if (-1 == bind(sock, (struct sockaddr*)&sock_addr, sizeof(sock_addr))) {
             throw std::runtime_error(std::string("Nancy-socket: ")+std::string(strerror(errno)));
         }
-        if (-1 == listen(sock, 30)) {
+        if (-1 == listen(sock, backlog)) {
             throw std::runtime_error(std::string("Nancy-socket: ")+std::string(strerror(errno)));
         }
     }
@@ -71,9 +82,42 @@ public:
      * @return 成功: fd ; 失败: -1
      */
     int accept_req() {
-        struct sockaddr_in tcp_clnt_addr;
-        socklen_t addr_sz = sizeof(tcp_clnt_addr);
-        return accept(sock, (struct sockaddr*)&tcp_clnt_addr, &addr_sz);
+        return accept4(sock, nullptr, nullptr, 0);
+    }
+
+    /**
+     * @brief 同上，由accept4直接设置新连接的属性
+     * @param flags SOCK_NONBLOCK、SOCK_CLOEXEC的组合，省去之后设置非阻塞的fcntl调用
+     * @param peer 非空时写入对端地址
+     * @return 成功: fd ; 失败: -1
+     */
+    int accept_req(int flags, struct sockaddr_in* peer = nullptr) {
+        socklen_t addr_sz = sizeof(*peer);
+        return accept4(sock, (struct sockaddr*)peer, peer ? &addr_sz : nullptr, flags);
+    }
+
+    /**
+     * @brief 批量接收连接，直到队列为空或达到max个
+     * @param fds 接收新连接的数组
+     * @param max 最多接收的个数
+     * @param flags 传给accept4的标志，默认为SOCK_NONBLOCK|SOCK_CLOEXEC
+     * @param peers 非空时依次写入对端地址，长度不小于max
+     * @return 接收的个数；小于max时队列已空(或出错)，等于max时可能仍有连接等待
+     * @note 监听套接字需为非阻塞
+     */
+    int accept_batch(int* fds, int max, int flags = SOCK_NONBLOCK | SOCK_CLOEXEC, struct sockaddr_in* peers = nullptr) {
+        int nums = 0;
+        while (nums < max) {
+            int fd = accept_req(flags, peers ? peers + nums : nullptr);
+            if (fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) {  // 对端已放弃的连接不影响后续的连接
+                    continue;
+                }
+                break;
+            }
+            fds[nums++] = fd;
+        }
+        return nums;
     }
 
     /**
@@ -147,10 +191,41 @@ public:
         sock_addr.sin_family = AF_INET;
         sock_addr.sin_port = htons(remote_port);
         if (-1 == connect(sock, (struct sockaddr*)&sock_addr, sizeof(sock_addr))) {
-            std::runtime_error(std::string("Nancy-socket: ")+std::string(strerror(errno)));
+            throw std::runtime_error(std::string("Nancy-socket: ")+std::string(strerror(errno)));
         }
     }
 
+    /**
+     * @brief 以非阻塞方式发起连接请求，套接字被设置为非阻塞
+     * @param remote_ip 远程ip
+     * @param remote_port 远程端口
+     * @return 立即完成时返回true；返回false时连接仍在进行，套接字可写后以get_connect_error获取结果
+     * @note 失败抛出异常信息。由反应堆等待完成并支持超时的版本见reactor::async_connect
+     */
+    bool launch_async_req(const char* remote_ip, int remote_port) {
+        struct sockaddr_in sock_addr;
+        memset(&sock_addr, 0, sizeof(sock_addr));
+        inet_pton(AF_INET, remote_ip, &sock_addr.sin_addr);
+        sock_addr.sin_family = AF_INET;
+        sock_addr.sin_port = htons(remote_port);
+        net::set_nonblocking(sock);
+        if (0 == connect(sock, (struct sockaddr*)&sock_addr, sizeof(sock_addr))) {
+            return true;
+        }
+        if (errno != EINPROGRESS) {
+            throw std::runtime_error(std::string("Nancy-socket: ")+std::string(strerror(errno)));
+        }
+        return false;
+    }
+
+    /**
+     * @brief 获取非阻塞连接的结果
+     * @return 0为已连接，否则为错误码
+     */
+    int get_connect_error() const noexcept {
+        return net::get_connect_error(sock);
+    }
+
     /**
      * @brief 返回内部fd
      * @return fd
@@ -179,6 +254,240 @@ public:
     }
 };
 
+// UDP数据报，addr为空时发送到connect_req指定的对端
+struct datagram {
+    const char* data;
+    size_t len;
+    const struct sockaddr_in* addr;
+};
+
+/**
+ * @brief 基于udp协议的套接字，创建时即为非阻塞，在析构函数中自动关闭
+ * @note 批量发送使用sendmmsg，大块数据可通过UDP_SEGMENT(GSO)由内核切分为等长的数据报，
+ *       内核不支持时退化为sendmmsg。批量接收见reactor::add_datagram_receiver
+ */
+class udp_socket : public socket_base {
+    int sock = 0;
+    int8_t gso = 0;  // UDP_SEGMENT状态: 0未知，1可用，-1不可用
+
+public:
+    explicit udp_socket() {
+        sock = socket(PF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        assert(-1 != sock);
+    }
+    explicit udp_socket(int fd): sock(fd) {}
+    udp_socket(const udp_socket&) = delete;
+    udp_socket(udp_socket&& other) noexcept {
+        sock = other.release();
+        gso = other.gso;
+    }
+    udp_socket& operator=(const udp_socket&) = delete;
+    udp_socket& operator=(udp_socket&& other) noexcept {
+        shutdown();
+        sock = other.release();
+        gso = other.gso;
+        return *this;
+    }
+    ~udp_socket() noexcept {
+        shutdown();
+    }
+
+public:
+    /**
+     * @brief 绑定本地地址
+     * @param ip 地址
+     * @param port 端口，0为由内核分配
+     * @return 失败抛出异常信息
+     */
+    void bind_req(const char* ip, int port) {
+        struct sockaddr_in sock_addr = make_addr(ip, port);
+        if (-1 == bind(sock, (struct sockaddr*)&sock_addr, sizeof(sock_addr))) {
+            throw std::runtime_error(std::string("Nancy-socket: ")+std::string(strerror(errno)));
+        }
+    }
+
+    /**
+     * @brief 指定默认对端，此后只接收该对端的数据报，发送时可不指定地址
+     * @param remote_ip 远程ip
+     * @param remote_port 远程端口
+     * @return 失败抛出异常信息
+     */
+    void connect_req(const char* remote_ip, int remote_port) {
+        struct sockaddr_in sock_addr = make_addr(remote_ip, remote_port);
+        if (-1 == connect(sock, (struct sockaddr*)&sock_addr, sizeof(sock_addr))) {
+            throw std::runtime_error(std::string("Nancy-socket: ")+std::string(strerror(errno)));
+        }
+    }
+
+    // 获取绑定的本地地址
+    struct sockaddr_in local_addr() const {
+        struct sockaddr_in addr;
+        socklen_t len = sizeof(addr);
+        memset(&addr, 0, sizeof(addr));
+        getsockname(sock, (struct sockaddr*)&addr, &len);
+        return addr;
+    }
+
+    /**
+     * @brief 开启UDP_GRO，内核将同一流的连续数据报合并后一次交付
+     * @return 内核不支持时返回false
+     * @note reactor::add_datagram_receiver会按合并时的分段长度将其拆分为原来的数据报
+     */
+    bool enable_gro() noexcept {
+        int on = 1;
+        return setsockopt(sock, SOL_UDP, UDP_GRO, &on, sizeof(on)) == 0;
+    }
+
+    /**
+     * @brief 以sendmmsg批量发送数据报
+     * @param dgs 数据报
+     * @param nums 个数
+     * @return 发送的个数，发送缓冲区满时可能小于nums；一个都未能发送时返回-1并设置errno
+     */
+    int send_batch(const datagram* dgs, int nums) {
+        struct mmsghdr msgs[config::udp_batch];
+        struct iovec iovs[config::udp_batch];
+        int sent = 0;
+        while (sent < nums) {
+            int cnt = nums - sent < config::udp_batch ? nums - sent : config::udp_batch;
+            memset(msgs, 0, sizeof(msgs[0]) * cnt);
+            for (int i = 0; i < cnt; ++i) {
+                const datagram& dg = dgs[sent + i];
+                iovs[i].iov_base = const_cast<char*>(dg.data);
+                iovs[i].iov_len = dg.len;
+                msgs[i].msg_hdr.msg_iov = &iovs[i];
+                msgs[i].msg_hdr.msg_iovlen = 1;
+                msgs[i].msg_hdr.msg_name = const_cast<struct sockaddr_in*>(dg.addr);
+                msgs[i].msg_hdr.msg_namelen = dg.addr ? sizeof(*dg.addr) : 0;
+            }
+            int ret = sendmmsg(sock, msgs, cnt, 0);
+            if (ret <= 0) {
+                return sent ? sent : -1;
+            }
+            sent += ret;
+            if (ret < cnt) {
+                break;
+            }
+        }
+        return sent;
+    }
+
+    /**
+     * @brief 将一块数据按segment字节切分为多个数据报发送到同一对端
+     * @param data 数据
+     * @param len 字节数，最后一个数据报可以短于segment
+     * @param segment 每个数据报的字节数
+     * @param addr 对端地址，为空时发送到connect_req指定的对端
+     * @return 发送的字节数（按整数据报计），一个都未能发送时返回-1并设置errno
+     * @note 使用UDP_SEGMENT时一次系统调用即可发送最多config::udp_max_segments个数据报，
+     *       由内核(或网卡)完成切分；内核不支持时退化为send_batch
+     */
+    ssize_t send_segments(const char* data, size_t len, uint16_t segment, const struct sockaddr_in* addr = nullptr) {
+        assert(segment > 0);
+        size_t sent = 0;
+        size_t segs = 65507 / segment < static_cast<size_t>(config::udp_max_segments)  // 合并后仍受UDP最大长度限制
+                          ? 65507 / segment : config::udp_max_segments;
+        while (sent < len && gso >= 0 && segs > 1) {
+            size_t chunk = len - sent < segment * segs ? len - sent : segment * segs;
+            ssize_t ret = send_gso(data + sent, chunk, segment, addr);
+            if (ret < 0) {
+                if (errno != EIO && errno != EINVAL && errno != ENOPROTOOPT) {  // 内核或网卡不支持时返回这些错误
+                    return sent ? static_cast<ssize_t>(sent) : -1;
+                }
+                gso = -1;
+                break;
+            }
+            gso = 1;
+            sent += ret;
+        }
+        datagram dgs[config::udp_batch];
+        while (sent < len) {
+            int cnt = 0;
+            size_t offset = sent;
+            for (; cnt < config::udp_batch && offset < len; ++cnt) {
+                size_t n = len - offset < segment ? len - offset : segment;
+                dgs[cnt] = datagram{data + offset, n, addr};
+                offset += n;
+            }
+            int ret = send_batch(dgs, cnt);
+            if (ret <= 0) {
+                return sent ? static_cast<ssize_t>(sent) : -1;
+            }
+            for (int i = 0; i < ret; ++i) {
+                sent += dgs[i].len;
+            }
+            if (ret < cnt) {
+                break;
+            }
+        }
+        return static_cast<ssize_t>(sent);
+    }
+
+    /**
+     * @brief 返回内部fd
+     * @return fd
+     */
+    int get_fd() const noexcept override {
+        return sock;
+    }
+
+    /**
+     * @brief 关闭套接字
+     * @note 该函数时可重入的
+     */
+    void shutdown() noexcept override {
+        if (sock) {
+            close(sock);
+            sock = 0;
+        }
+    }
+
+    /**
+     * @brief 获取该fd并将内部fd置为0，类似智能指针的release
+     * @return 内部fd
+     */
+    int release() noexcept override {
+        int ret = sock;
+        sock = 0;
+        return ret;
+    }
+
+private:
+    static struct sockaddr_in make_addr(const char* ip, int port) {
+        struct sockaddr_in sock_addr;
+        memset(&sock_addr, 0, sizeof(sock_addr));
+        inet_pton(AF_INET, ip, &sock_addr.sin_addr);
+        sock_addr.sin_family = AF_INET;
+        sock_addr.sin_port = htons(port);
+        return sock_addr;
+    }
+
+    // 以一次sendmsg发送带UDP_SEGMENT控制信息的数据
+    ssize_t send_gso(const char* data, size_t len, uint16_t segment, const struct sockaddr_in* addr) {
+        char control[CMSG_SPACE(sizeof(uint16_t))];
+        memset(control, 0, sizeof(control));
+        struct iovec iov;
+        iov.iov_base = const_cast<char*>(data);
+        iov.iov_len = len;
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_name = const_cast<struct sockaddr_in*>(addr);
+        msg.msg_namelen = addr ? sizeof(*addr) : 0;
+        if (len > segment) {  // 只有一个数据报时不需要切分
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+            struct cmsghdr* cm = CMSG_FIRSTHDR(&msg);
+            cm->cmsg_level = SOL_UDP;
+            cm->cmsg_type = UDP_SEGMENT;
+            cm->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+            memcpy(CMSG_DATA(cm), &segment, sizeof(segment));
+        }
+        return sendmsg(sock, &msg, 0);
+    }
+};
+
 /**
  * @brief a pair of socket
  * @note 全双工
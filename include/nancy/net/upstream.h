@@ -0,0 +1,277 @@
+#pragma once
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <deque>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include "nancy/net/reactor.h"
+
+namespace nc::net {
+
+/**
+ * @brief 上游连接池，按对端地址复用反应堆中已建立的连接，热路径上不再等待TCP握手
+ * @note  空闲连接后进先出，每个地址至多保留max_idle个，超过空闲超时的连接被关闭
+ * @note  空闲期间收到数据或对端关闭的连接被关闭；取出时再以MSG_PEEK确认对端未关闭，可选定期的主动健康检查
+ * @note  主动探测期间连接暂时移出空闲列表，回复交给检查函数，确认后再放回
+ * @note  非线程安全，只在所属反应堆的线程中使用；每个反应堆(节点)各自拥有连接池，生命周期应覆盖反应堆的运行
+ */
+class upstream_pool {
+    reactor* rec;
+    size_t max_idle;
+    int idle_ms;
+    int connect_ms;
+    std::unordered_map<uint64_t, std::deque<handle_t>> idle = {};  // 对端地址 -> 空闲连接句柄
+    std::function<bool(connection*)> health_check = {};
+    std::function<bool(connection*)> health_reply = {};
+    std::unordered_set<handle_t> probing = {};  // 已发送探测、等待回复的连接
+    timer_id health_timer = 0;
+    size_t created = 0;
+    size_t reused = 0;
+
+public:
+    /**
+     * @param rec 所属的反应堆
+     * @param max_idle 每个对端地址最多保留的空闲连接数
+     * @param idle_ms 空闲连接的超时(毫秒)，0为不限
+     * @param connect_ms 建立连接的超时(毫秒)，0为不限
+     */
+    explicit upstream_pool(reactor* rec, size_t max_idle = config::upstream_max_idle,
+                           int idle_ms = config::upstream_idle_ms, int connect_ms = config::upstream_connect_ms)
+        : rec(rec)
+        , max_idle(max_idle)
+        , idle_ms(idle_ms)
+        , connect_ms(connect_ms) {}
+    upstream_pool(const upstream_pool&) = delete;
+    upstream_pool& operator=(const upstream_pool&) = delete;
+    ~upstream_pool() {
+        if (health_timer) {
+            rec->cancel(health_timer);
+        }
+    }
+
+public:
+    /**
+     * @brief 获取到对端的连接：优先复用空闲连接，否则以reactor::async_connect建立新连接
+     * @param addr 对端地址
+     * @param cb 回调void(connection*, int err)，失败时连接为nullptr、err为错误码(超时为ETIMEDOUT)
+     * @note 复用时回调立即执行，新建时在连接完成后执行；取得的连接没有消息回调，由使用者以set_message_cb设置
+     */
+    template <typename F, typename = typename std::enable_if<nc::details::is_runnable<F, connection*, int>::value>::type>
+    void acquire(const struct sockaddr_in& addr, F&& cb) {
+        auto it = idle.find(key_of(addr));
+        while (it != idle.end() && !it->second.empty()) {
+            connection* conn = rec->get_connection(it->second.back());
+            it->second.pop_back();
+            if (conn && peer_alive(conn)) {
+                ++reused;
+                checkout(conn);
+                cb(conn, 0);
+                return;
+            }
+            if (conn) {
+                rec->close_connection(conn);
+            }
+        }
+        std::function<void(connection*, int)> done(std::forward<F>(cb));
+        rec->async_connect(addr, connect_ms, [this, done](int fd, int err) {
+            if (fd < 0) {
+                done(nullptr, err);
+                return;
+            }
+            ++created;
+            done(rec->add_connection(fd, [](connection*) {}), 0);
+        });
+    }
+
+    /**
+     * @brief 同上
+     * @param ip 对端ip
+     * @param port 对端端口
+     */
+    template <typename F, typename = typename std::enable_if<nc::details::is_runnable<F, connection*, int>::value>::type>
+    void acquire(const char* ip, int port, F&& cb) {
+        acquire(make_addr(ip, port), std::forward<F>(cb));
+    }
+
+    /**
+     * @brief 归还连接。连接应处于请求之间的空闲状态，输入缓冲区中的数据被丢弃
+     * @param conn 由acquire取得的连接
+     * @note 已关闭、仍有待发送数据或该地址的空闲连接已满时直接关闭
+     */
+    void release(connection* conn) {
+        if (conn->is_closed()) {
+            return;
+        }
+        struct sockaddr_in addr;
+        socklen_t len = sizeof(addr);
+        if (conn->pending_bytes() || -1 == getpeername(conn->get_fd(), (struct sockaddr*)&addr, &len)) {
+            rec->close_connection(conn);
+            return;
+        }
+        auto& list = idle[key_of(addr)];
+        if (list.size() >= max_idle) {  // 清理已关闭的连接后再判断
+            prune(list);
+        }
+        if (list.size() >= max_idle) {
+            rec->close_connection(conn);
+            return;
+        }
+        conn->input()->retrieve_all();
+        conn->set_close_cb(connection_callback_t());
+        watch_idle(conn);
+        rec->set_idle_timeout(conn, idle_ms);
+        list.push_back(conn->get_handle());
+    }
+
+    /**
+     * @brief 设置被动健康检查：每隔interval_ms对每个空闲连接调用一次check，返回false的连接被关闭
+     * @param interval_ms 检查周期(毫秒)
+     * @param check 检查函数bool(connection*)，不应发送数据，空闲期间收到的数据会使连接被关闭
+     */
+    template <typename F, typename = typename std::enable_if<std::is_constructible<std::function<bool(connection*)>, F>::value>::type>
+    void set_health_check(int interval_ms, F&& check) {
+        health_check = std::forward<F>(check);
+        health_reply = nullptr;
+        start_check(interval_ms);
+    }
+
+    /**
+     * @brief 设置主动健康检查：每隔interval_ms对每个空闲连接调用probe发送探测请求，回复到达时交给reply
+     * @param interval_ms 检查周期(毫秒)，下一周期仍未收到完整回复的连接被关闭
+     * @param probe 探测函数bool(connection*)，返回false的连接被关闭
+     * @param reply 回复检查函数bool(connection*)，从输入缓冲区取出回复；返回false的连接被关闭，
+     *              返回true且输入缓冲区已取空时检查完成，连接放回空闲列表，回复不完整时应保留在缓冲区中
+     */
+    template <typename F, typename G,
+              typename = typename std::enable_if<std::is_constructible<std::function<bool(connection*)>, F>::value &&
+                                                 std::is_constructible<std::function<bool(connection*)>, G>::value>::type>
+    void set_health_check(int interval_ms, F&& probe, G&& reply) {
+        health_check = std::forward<F>(probe);
+        health_reply = std::forward<G>(reply);
+        start_check(interval_ms);
+    }
+
+    // 对端地址的空闲连接数(含尚未清理的已关闭连接)
+    size_t idle_nums(const char* ip, int port) const {
+        auto it = idle.find(key_of(make_addr(ip, port)));
+        return it == idle.end() ? 0 : it->second.size();
+    }
+
+    // 新建的连接数
+    size_t created_nums() const noexcept {
+        return created;
+    }
+
+    // 复用空闲连接的次数
+    size_t reused_nums() const noexcept {
+        return reused;
+    }
+
+private:
+    static struct sockaddr_in make_addr(const char* ip, int port) {
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        inet_pton(AF_INET, ip, &addr.sin_addr);
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        return addr;
+    }
+
+    static uint64_t key_of(const struct sockaddr_in& addr) {
+        return (static_cast<uint64_t>(addr.sin_addr.s_addr) << 16) | addr.sin_port;
+    }
+
+    // 对端是否仍未关闭，且没有意外到达的数据
+    static bool peer_alive(connection* conn) {
+        char c;
+        ssize_t n = recv(conn->get_fd(), &c, 1, MSG_PEEK | MSG_DONTWAIT);
+        return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+    }
+
+    // 空闲时不应收到数据
+    void watch_idle(connection* conn) {
+        conn->set_message_cb([this](connection* c) { rec->close_connection(c); });
+    }
+
+    // 交给使用者前撤销空闲期间的设置
+    void checkout(connection* conn) {
+        conn->set_message_cb([](connection*) {});
+        rec->set_idle_timeout(conn, 0);
+    }
+
+    void prune(std::deque<handle_t>& list) {
+        std::deque<handle_t> live;
+        for (handle_t h : list) {
+            if (rec->get_connection(h)) {
+                live.push_back(h);
+            }
+        }
+        list.swap(live);
+    }
+
+    void start_check(int interval_ms) {
+        if (health_timer) {
+            rec->cancel(health_timer);
+        }
+        health_timer = rec->run_every(interval_ms, [this] { check_idle(); });
+    }
+
+    void check_idle() {
+        for (handle_t h : probing) {  // 上一周期的探测未收到完整回复
+            connection* conn = rec->get_connection(h);
+            if (conn) {
+                rec->close_connection(conn);
+            }
+        }
+        probing.clear();
+        for (auto& entry : idle) {
+            prune(entry.second);
+            std::deque<handle_t> list;
+            list.swap(entry.second);
+            for (handle_t h : list) {
+                connection* conn = rec->get_connection(h);
+                if (!conn) {
+                    continue;
+                }
+                if (!health_reply) {
+                    if (health_check(conn)) {
+                        entry.second.push_back(h);
+                    } else {
+                        rec->close_connection(conn);
+                    }
+                    continue;
+                }
+                // 探测期间不能被取出，回复交给检查函数而不是空闲时的消息回调
+                uint64_t key = entry.first;
+                conn->set_message_cb([this, key](connection* c) { on_reply(c, key); });
+                if (health_check(conn)) {
+                    probing.insert(h);
+                } else {
+                    rec->close_connection(conn);
+                }
+            }
+        }
+    }
+
+    void on_reply(connection* conn, uint64_t key) {
+        if (!health_reply(conn)) {
+            rec->close_connection(conn);
+            return;
+        }
+        if (conn->input()->readable_bytes()) {  // 回复尚未完整
+            return;
+        }
+        probing.erase(conn->get_handle());
+        auto& list = idle[key];
+        if (list.size() >= max_idle) {
+            rec->close_connection(conn);
+            return;
+        }
+        watch_idle(conn);
+        list.push_back(conn->get_handle());
+    }
+};
+
+}  // namespace nc::net
@@ -0,0 +1,99 @@
+#include <linux/mempolicy.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <thread>
+#include "nancy/net/creactors.h"
+using namespace nc;
+
+// ================================================================================
+//         CPU亲和性与NUMA放置: 工作节点绑定CPU，并优先使用本地节点的内存
+// ================================================================================
+
+const int port = 9104;
+const int nodes = 2;
+
+// 调用线程允许运行的唯一CPU，不唯一时返回-1
+int pinned_cpu() {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    assert(sched_getaffinity(0, sizeof(set), &set) == 0);
+    if (CPU_COUNT(&set) != 1) {
+        return -1;
+    }
+    int cpu = 0;
+    while (!CPU_ISSET(cpu, &set)) {
+        ++cpu;
+    }
+    return cpu;
+}
+
+int memory_policy() {
+    int mode = -1;
+    assert(syscall(SYS_get_mempolicy, &mode, nullptr, 0, nullptr, 0) == 0);
+    return mode;
+}
+
+void test_topology() {
+    assert((net::parse_cpu_list("0-3,8,10-11") == std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+    assert(net::parse_cpu_list("").empty());
+    int numa = net::numa_node_of_cpu(0);
+    if (numa >= 0) {
+        auto cpus = net::numa_cpus(numa);
+        assert(std::find(cpus.begin(), cpus.end(), 0) != cpus.end());
+    }
+    assert(net::numa_cpus(-1).empty());
+    assert(net::numa_node_of_device("lo") == -1);  // 虚拟网卡没有所在节点
+    assert(!net::pin_thread(std::vector<int>{}));
+    std::cout << "cpu0 numa node: " << numa << std::endl;
+}
+
+void test_placement() {
+    net::creactors recs;
+    net::tcp_serv_socket sock;
+    net::set_reuse_address(sock.get_fd());
+    sock.listen_req("127.0.0.1", port);
+    recs.bind_serv_socket(std::move(sock));
+    recs.init_async_nodes(nodes);
+    if (net::numa_node_of_cpu(0) >= 0) {
+        assert(recs.set_numa_node(net::numa_node_of_cpu(0)));
+    }
+    assert(!recs.set_numa_node(-1));
+    assert(!recs.set_numa_device("lo"));
+    recs.set_cpu_affinity({0}, 0);
+
+    std::atomic<int> placed = {0};
+    recs.set_message_cb([&](net::reactor* rec, net::connection* conn) {
+        conn->input()->retrieve_all();
+        if (pinned_cpu() == 0 && memory_policy() == MPOL_PREFERRED) {
+            ++placed;
+        }
+        rec->send(conn, "ok", 2);
+    });
+    int root_cpu = -1;
+    std::thread client([&] {
+        for (int i = 0; i < 2 * nodes; ++i) {  // 轮询分发，每个节点都会收到连接
+            net::tcp_clnt_socket clnt;
+            clnt.launch_req("127.0.0.1", port);
+            char buf[2];
+            assert(write(clnt.get_fd(), "?", 1) == 1 && read(clnt.get_fd(), buf, 2) == 2);
+        }
+        recs.root()->post([&] {
+            root_cpu = pinned_cpu();
+            recs.root()->destroy();
+        });
+    });
+    recs.activate();
+    client.join();
+    std::cout << "placed: " << placed << " root cpu: " << root_cpu << std::endl;
+    assert(placed == 2 * nodes);
+    assert(root_cpu == 0);
+}
+
+int main() {
+    test_topology();
+    test_placement();
+}
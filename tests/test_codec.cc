@@ -0,0 +1,153 @@
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "nancy/net/codec.h"
+using namespace nc;
+
+// ================================================================================
+//         长度前缀分帧: CRC32C、分段到达的帧、错误帧、一次读入的大量流水线帧
+// ================================================================================
+
+const int port = 9111;
+
+void test_crc32c() {
+    assert(net::crc32c("123456789", 9) == 0xe3069283u);
+    assert(net::crc32c("", 0) == 0);
+    // 分段计算与一次计算一致，硬件实现与查表实现一致(含非8字节对齐的起点与长度)
+    std::mt19937 rng(7);
+    std::vector<char> data(4096);
+    for (auto& c : data) {
+        c = static_cast<char>(rng());
+    }
+    for (int i = 0; i < 200; ++i) {
+        size_t off = rng() % 64;
+        size_t len = rng() % (data.size() - off);
+        size_t half = len / 2;
+        uint32_t whole = net::crc32c(data.data() + off, len);
+        assert(net::crc32c(data.data() + off + half, len - half, net::crc32c(data.data() + off, half)) == whole);
+        assert(~net::_codec::crc32c_table(~0u, data.data() + off, len) == whole);
+    }
+}
+
+// 按frames编码后逐字节喂入，每帧在最后一个字节到达时交付，视图指向输入缓冲区
+void test_partial(net::length_format_t format, bool checksum) {
+    net::frame_codec codec(format, checksum);
+    std::vector<std::string> frames = {"", "a", std::string(127, 'b'), std::string(128, 'c'), std::string(20000, 'd')};
+    net::buffer encoded;
+    for (auto& f : frames) {
+        codec.encode(&encoded, f.data(), f.size());
+    }
+    net::buffer in;
+    std::vector<std::string> got;
+    const char* data = encoded.peek();
+    for (size_t i = 0; i < encoded.readable_bytes(); ++i) {
+        in.append(data + i, 1);
+        int n = codec.decode(&in, [&](net::frame_view view) {
+            assert(view.data >= in.peek() && view.data + view.len <= in.peek() + in.readable_bytes());
+            got.emplace_back(view.data, view.len);
+            return true;
+        });
+        assert(n >= 0);
+    }
+    assert(got == frames);
+    assert(in.readable_bytes() == 0);
+
+    // 一次到达的全部帧在一次解码中交付；回调返回false时其后的帧留在缓冲区中
+    in.append(encoded.peek(), encoded.readable_bytes());
+    int first = codec.decode(&in, [](net::frame_view) { return false; });
+    assert(first == 1);
+    assert(codec.decode(&in, [](net::frame_view) { return true; }) == static_cast<int>(frames.size()) - 1);
+    assert(in.readable_bytes() == 0);
+}
+
+void test_errors() {
+    auto noop = [](net::frame_view) { return true; };
+    {  // 超过5字节的变长整数
+        net::frame_codec codec;
+        net::buffer in;
+        in.append("\x80\x80\x80\x80\x80\x01", 6);
+        assert(codec.decode(&in, noop) == -1);
+    }
+    {  // 超过上限的长度，此前的帧照常交付
+        net::frame_codec codec(net::length_format::fixed32, false, 16);
+        net::buffer in;
+        codec.encode(&in, "ok", 2);
+        in.append("\x00\x00\x00\x11", 4);
+        int delivered = 0;
+        assert(codec.decode(&in, [&](net::frame_view) { return ++delivered; }) == -1);
+        assert(delivered == 1);
+    }
+    {  // 校验和不匹配
+        net::frame_codec codec(net::length_format::fixed16, true);
+        net::buffer in;
+        codec.encode(&in, "hello", 5);
+        std::string raw(in.peek(), in.readable_bytes());
+        raw[3] ^= 1;
+        in.retrieve_all();
+        in.append(raw.data(), raw.size());
+        assert(codec.decode(&in, noop) == -1);
+    }
+}
+
+// 客户端一次写入大量帧，服务端按帧回显，客户端逐帧校验
+void test_pipeline(net::backend_t engine) {
+    const int frames = 10000;
+    net::frame_codec codec(net::length_format::varint, true);
+    net::reactor rec(-1, engine);
+    net::tcp_serv_socket sock;
+    net::set_reuse_address(sock.get_fd());
+    sock.listen_req("127.0.0.1", port);
+    int served = 0;
+    int max_batch = 0;
+    rec.add_acceptor(sock.get_fd(), [&](int fd) {
+        rec.add_connection(fd, [&](net::connection* conn) {
+            int batch = codec.decode(conn->input(), [&](net::frame_view view) {
+                codec.send(&rec, conn, view.data, view.len);
+                ++served;
+                return true;
+            });
+            assert(batch >= 0);
+            max_batch = batch > max_batch ? batch : max_batch;
+        });
+    });
+
+    std::vector<std::string> sent;
+    net::buffer out;
+    for (int i = 0; i < frames; ++i) {
+        sent.push_back(std::string(i % 300, static_cast<char>('a' + i % 26)) + std::to_string(i));
+        codec.encode(&out, sent.back().data(), sent.back().size());
+    }
+    int received = 0;
+    bool closed = false;
+    net::tcp_clnt_socket clnt;
+    clnt.launch_req("127.0.0.1", port);
+    net::connection* client = rec.add_connection(clnt.release(), codec.wrap([&](net::connection* conn, net::frame_view view) {
+        assert(std::string(view.data, view.len) == sent[received]);
+        if (++received == frames) {
+            rec.close_connection(conn);
+            closed = true;
+            rec.destroy();
+        }
+    }));
+    rec.send(client, out.peek(), out.readable_bytes());
+    rec.activate();
+    std::cout << "pipeline served: " << served << " received: " << received << " max frames per read: " << max_batch
+              << std::endl;
+    assert(served == frames && received == frames && closed);
+    assert(max_batch > 1);
+}
+
+int main() {
+    test_crc32c();
+    for (auto format : {net::length_format::varint, net::length_format::fixed16, net::length_format::fixed32}) {
+        test_partial(format, false);
+        test_partial(format, true);
+    }
+    test_errors();
+    test_pipeline(net::backend::epoll);
+    test_pipeline(net::backend::uring);
+}
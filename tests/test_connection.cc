@@ -0,0 +1,231 @@
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "nancy/net/reactor.h"
+using namespace nc;
+
+// ================================================================================
+//         connection: 带缓冲的连接，大块回声数据需要经过输出缓冲区续写
+// ================================================================================
+
+const int port = 9092;
+const int conns = 10;
+const size_t payload = 1 << 20;  // 1MB，超过套接字发送缓冲区
+
+void test_buffer() {
+    net::buffer buf(8);
+    buf.append("hello", 5);
+    buf.append(" nancy", 6);
+    assert(buf.readable_bytes() == 11);
+    assert(buf.retrieve_as_string(5) == "hello");
+    buf.append("!!!!!!", 6);  // 回收已读取部分
+    assert(buf.retrieve_as_string(100) == " nancy!!!!!!");
+    assert(buf.readable_bytes() == 0);
+    std::cout << "buffer ok" << std::endl;
+}
+
+void test_echo(net::backend_t engine) {
+    net::reactor rec(-1, engine);
+    net::tcp_serv_socket serv;
+    net::set_reuse_address(serv.get_fd());
+    net::set_nonblocking(serv.get_fd());
+    serv.listen_req("127.0.0.1", port);
+
+    int closed = 0;
+    rec.add_socket(serv.get_fd(), net::event::readable, net::pattern::et, [&](int) {
+        int fd = 0;
+        while ((fd = serv.accept_req()) > 0) {
+            net::set_nonblocking(fd);
+            auto* conn = rec.add_connection(fd, [&rec](net::connection* conn) {
+                auto* in = conn->input();
+                rec.send(conn, in->peek(), in->readable_bytes());
+                in->retrieve_all();
+            });
+            conn->set_close_cb([&closed](net::connection*) { ++closed; });
+        }
+    });
+
+    size_t echoed = 0;
+    std::thread clients([&] {
+        std::unique_ptr<char[]> data(new char[payload]);
+        std::unique_ptr<char[]> back(new char[payload]);
+        for (size_t i = 0; i < payload; ++i) {
+            data[i] = static_cast<char>('a' + i % 26);
+        }
+        for (int i = 0; i < conns; ++i) {
+            net::tcp_clnt_socket clnt;
+            clnt.launch_req("127.0.0.1", port);
+            // 不读取回声先写完全部数据，迫使服务端积压输出
+            std::thread writer([&] {
+                size_t sent = 0;
+                ssize_t bytes = 0;
+                while (sent < payload && (bytes = write(clnt.get_fd(), data.get() + sent, payload - sent)) > 0) {
+                    sent += bytes;
+                }
+            });
+            size_t got = 0;
+            ssize_t bytes = 0;
+            while (got < payload && (bytes = read(clnt.get_fd(), back.get() + got, payload - got)) > 0) {
+                got += bytes;
+            }
+            writer.join();
+            if (got == payload && !memcmp(data.get(), back.get(), payload)) {
+                echoed += got;
+            }
+        }
+        rec.post([&rec] { rec.run_after(50, [&rec] { rec.destroy(); }); });  // 等待服务端处理关闭
+    });
+    rec.activate();
+    clients.join();
+    std::cout << "echoed: " << echoed << " closed: " << closed << std::endl;
+    assert(echoed == payload * conns);
+    assert(closed == conns);
+}
+
+// 写合并: 一轮循环中的多次小消息写入在循环末尾以一次发送完成
+void test_cork(net::backend_t engine) {
+    const int pieces = 10;
+    net::reactor rec(-1, engine);
+    rec.set_cork(true);
+    net::tcp_serv_socket serv;
+    net::set_reuse_address(serv.get_fd());
+    net::set_nonblocking(serv.get_fd());
+    serv.listen_req("127.0.0.1", port);
+
+    rec.add_socket(serv.get_fd(), net::event::readable, net::pattern::et, [&](int) {
+        int fd = 0;
+        while ((fd = serv.accept_req()) > 0) {
+            net::set_nonblocking(fd);
+            rec.add_connection(fd, [&rec](net::connection* conn) {
+                conn->input()->retrieve_all();
+                for (int i = 0; i < pieces; ++i) {
+                    char c = static_cast<char>('0' + i);
+                    rec.send(conn, &c, 1);
+                    rec.post([&rec, conn, c] { rec.send(conn, &c, 1); });  // 同样在本轮末尾之前执行
+                }
+                assert(conn->pending_bytes() == pieces);
+            });
+        }
+    });
+
+    std::string got;
+    std::thread client([&] {
+        net::tcp_clnt_socket clnt;
+        clnt.launch_req("127.0.0.1", port);
+        assert(write(clnt.get_fd(), "?", 1) == 1);
+        char buf[64];
+        ssize_t bytes = read(clnt.get_fd(), buf, sizeof(buf));
+        got.assign(buf, bytes > 0 ? bytes : 0);
+        assert(got.size() >= pieces);  // 同一轮的写入合并为一个报文段
+        while (got.size() < 2 * pieces && (bytes = read(clnt.get_fd(), buf, sizeof(buf))) > 0) {
+            got.append(buf, bytes);
+        }
+        rec.post([&rec] { rec.destroy(); });
+    });
+    rec.activate();
+    client.join();
+    uint64_t updates = rec.metrics().interest_updates;
+    std::cout << "corked: " << got << " interest updates: " << updates << std::endl;
+    assert(got == "01234567890123456789");
+    assert(updates == 0);  // 每次写入都并入循环末尾的发送，不关注可写事件
+}
+
+// fd号被复用后，旧句柄上的投递、定时任务与发送都被丢弃
+void test_handle() {
+    net::reactor rec;
+    int a[2], b[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, a) == 0);
+    net::set_nonblocking(a[0]);
+    auto* conn = rec.add_connection(a[0], [](net::connection*) {});
+    net::handle_t old_handle = conn->get_handle();
+    assert(rec.alive(old_handle) && rec.get_handle(a[0]) == old_handle);
+    assert(rec.get_connection(old_handle) == conn);
+    rec.close_connection(conn);
+    assert(!rec.alive(old_handle) && !rec.get_connection(old_handle));
+    assert(!rec.send(old_handle, "x", 1));
+
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, b) == 0);  // 通常复用刚关闭的fd号
+    net::set_nonblocking(b[0]);
+    net::handle_t new_handle = rec.add_connection(b[0], [](net::connection*) {})->get_handle();
+    assert(new_handle != old_handle);
+    std::cout << "fd reused: " << (net::handle::fd_of(new_handle) == net::handle::fd_of(old_handle)) << std::endl;
+
+    int stale = 0;
+    int fresh = 0;
+    std::thread other([&] {
+        rec.post(old_handle, [&stale] { ++stale; });
+        rec.post(new_handle, [&fresh] { ++fresh; });
+        rec.post([&] {
+            rec.run_after(old_handle, 0, [&stale] { ++stale; });
+            rec.run_after(new_handle, 10, [&] {
+                assert(rec.send(new_handle, "ok", 2));
+                rec.destroy();
+            });
+        });
+    });
+    rec.activate();
+    other.join();
+    char buf[4] = {0};
+    assert(read(b[1], buf, sizeof(buf)) == 2);
+    std::cout << "stale: " << stale << " fresh: " << fresh << std::endl;
+    assert(stale == 0 && fresh == 1);
+    for (int fd : {a[1], b[1]}) {
+        close(fd);
+    }
+}
+
+// 空闲连接与发送积压的连接被时间轮关闭，持续有数据的连接不受影响
+void test_timeout() {
+    net::reactor rec;
+    rec.set_conn_timeout(300, 0);
+    int idle[2], active[2], slow[2];
+    for (int* sv : {idle, active, slow}) {
+        assert(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+        net::set_nonblocking(sv[0]);
+    }
+    int timeouts = 0;
+    auto on_close = [&timeouts](net::connection* conn) { timeouts += conn->is_timeout(); };
+    auto start = std::chrono::steady_clock::now();
+    long idle_ms = 0;
+    long slow_ms = 0;
+    auto* conn = rec.add_connection(idle[0], [](net::connection*) {});
+    conn->set_close_cb([&](net::connection* conn) {
+        on_close(conn);
+        idle_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    });
+    conn = rec.add_connection(active[0], [](net::connection* conn) { conn->input()->retrieve_all(); });
+    conn->set_close_cb(on_close);
+    // 对端不读取，输出积压后在发送超时内未能发送完毕
+    conn = rec.add_connection(slow[0], [](net::connection*) {});
+    conn->set_close_cb([&](net::connection* conn) {
+        on_close(conn);
+        slow_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    });
+    rec.set_idle_timeout(conn, 0);
+    rec.set_write_timeout(conn, 500);
+    std::string block(1 << 20, 's');
+    rec.send(conn, block.data(), block.size());
+    assert(conn->pending_bytes() > 0);
+
+    rec.run_every(50, [&] { assert(write(active[1], "a", 1) == 1); });
+    rec.run_after(1000, [&] { rec.destroy(); });
+    rec.activate();
+    std::cout << "timeouts: " << timeouts << " idle closed(ms): " << idle_ms << " slow closed(ms): " << slow_ms << std::endl;
+    assert(timeouts == 2);
+    assert(idle_ms >= 300 && idle_ms < 700);
+    assert(slow_ms >= 500 && slow_ms < 900);
+    for (int fd : {idle[1], active[1], slow[1]}) {
+        close(fd);
+    }
+}
+
+int main() {
+    test_buffer();
+    test_echo(net::backend::epoll);
+    test_echo(net::backend::uring);
+    test_cork(net::backend::epoll);
+    test_cork(net::backend::uring);
+    test_handle();
+    test_timeout();
+}
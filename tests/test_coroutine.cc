@@ -0,0 +1,110 @@
+#include <cassert>
+#include <iostream>
+#include <thread>
+#include "nancy/net/coroutine.h"
+using namespace nc;
+
+// ================================================================================
+//         C++20协程: 每个连接一个协程的回声服务
+// ================================================================================
+
+const int port = 9093;
+const int conns = 50;
+const size_t payload = 256 * 1024;  // 超过套接字缓冲区，async_write需要挂起
+
+int sessions = 0;
+
+net::co::task echo_session(net::reactor& rec, int fd) {
+    char buf[4096];
+    ssize_t bytes = 0;
+    while ((bytes = co_await net::co::async_read(rec, fd, buf, sizeof(buf))) > 0) {
+        if (co_await net::co::async_write(rec, fd, buf, bytes) != bytes) {
+            break;
+        }
+    }
+    net::co::close(rec, fd);
+    ++sessions;
+}
+
+net::co::task acceptor(net::reactor& rec, int listen_fd) {
+    for (;;) {
+        co_await net::co::readable(rec, listen_fd);
+        int fd = 0;
+        while ((fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK)) > 0) {
+            echo_session(rec, fd);
+        }
+    }
+}
+
+net::co::task ticker(net::reactor& rec, int& ticks) {
+    for (int i = 0; i < 3; ++i) {
+        co_await net::co::sleep_for(rec, std::chrono::milliseconds(10));
+        ++ticks;
+    }
+}
+
+void test_echo(net::backend_t engine) {
+    sessions = 0;
+    net::reactor rec(-1, engine);
+    net::tcp_serv_socket serv;
+    net::set_reuse_address(serv.get_fd());
+    net::set_nonblocking(serv.get_fd());
+    serv.listen_req("127.0.0.1", port);
+    acceptor(rec, serv.get_fd());
+
+    int ticks = 0;
+    ticker(rec, ticks);
+
+    size_t echoed = 0;
+    std::thread clients([&] {
+        std::unique_ptr<char[]> data(new char[payload]);
+        std::unique_ptr<char[]> back(new char[payload]);
+        for (size_t i = 0; i < payload; ++i) {
+            data[i] = static_cast<char>('a' + i % 26);
+        }
+        for (int i = 0; i < conns; ++i) {
+            net::tcp_clnt_socket clnt;
+            clnt.launch_req("127.0.0.1", port);
+            std::thread writer([&] {
+                size_t sent = 0;
+                ssize_t bytes = 0;
+                while (sent < payload && (bytes = write(clnt.get_fd(), data.get() + sent, payload - sent)) > 0) {
+                    sent += bytes;
+                }
+            });
+            size_t got = 0;
+            ssize_t bytes = 0;
+            while (got < payload && (bytes = read(clnt.get_fd(), back.get() + got, payload - got)) > 0) {
+                got += bytes;
+            }
+            writer.join();
+            if (got == payload && !memcmp(data.get(), back.get(), payload)) {
+                echoed += got;
+            }
+        }
+        rec.post([&rec] { rec.run_after(50, [&rec] { rec.destroy(); }); });
+    });
+    rec.activate();
+    clients.join();
+    rec.remove_socket(serv.get_fd());
+    std::cout << "echoed: " << echoed << " sessions: " << sessions << " ticks: " << ticks << std::endl;
+    assert(echoed == payload * conns);
+    assert(sessions == conns);
+    assert(ticks == 3);
+}
+
+void test_frame_pool() {
+    auto& pool = net::co::frame_pool::local();
+    void* a = pool.allocate(100);
+    pool.deallocate(a, 100);
+    void* b = pool.allocate(120);  // 同一级别，复用
+    assert(a == b);
+    pool.deallocate(b, 120);
+    std::cout << "frame pool ok" << std::endl;
+}
+
+int main() {
+    test_frame_pool();
+    test_echo(net::backend::epoll);
+    test_echo(net::backend::uring);
+}
@@ -0,0 +1,238 @@
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <sys/resource.h>
+#include <thread>
+#include <vector>
+#include "nancy/net/creactors.h"
+using namespace nc;
+
+// ================================================================================
+//         creactors接受连接: SO_REUSEPORT模式下每个工作节点独立监听，
+//         或由根节点以accept4批量接受后按分发策略转交
+// ================================================================================
+
+const int nodes = 4;
+const int clients = 4;
+const int conns = 100;  // 每个客户端线程的连接数
+
+// 各用例先后使用同一端口: 析构时等待工作线程退出，此前的监听套接字已全部关闭
+void test_accept(net::backend_t engine, bool reuseport, bool steering, int port) {
+    net::creactors recs(engine);
+    if (reuseport) {
+        recs.bind_reuseport("127.0.0.1", port, steering);
+    } else {
+        net::tcp_serv_socket sock;
+        net::set_reuse_address(sock.get_fd());
+        sock.listen_req("127.0.0.1", port, 16);  // 较小的队列，连接风暴时需要多批接受
+        recs.bind_serv_socket(std::move(sock));
+    }
+    recs.init_async_nodes(nodes);
+
+    std::atomic<int> accepted[nodes];
+    for (auto& n : accepted) {
+        n = 0;
+    }
+    std::vector<net::reactor*> workers;
+    for (int i = 0; i < nodes; ++i) {
+        workers.push_back(recs[i]);
+    }
+    recs.set_connect_cb([&](net::reactor* rec, int fd) {
+        assert(fcntl(fd, F_GETFL) & O_NONBLOCK);  // 由accept4设置
+        for (int i = 0; i < nodes; ++i) {
+            accepted[i] += workers[i] == rec;
+        }
+        rec->add_connection(fd, [rec](net::connection* conn) {
+            auto* in = conn->input();
+            rec->send(conn, in->peek(), in->readable_bytes());
+            in->retrieve_all();
+        });
+    });
+
+    std::atomic<int> echoed = {0};
+    std::thread root([&] {
+        std::vector<std::thread> threads;
+        for (int c = 0; c < clients; ++c) {
+            threads.emplace_back([&] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));  // 等待activate创建监听套接字
+                for (int i = 0; i < conns; ++i) {
+                    net::tcp_clnt_socket clnt;
+                    clnt.launch_req("127.0.0.1", port);
+                    char buf[4];
+                    if (write(clnt.get_fd(), "ping", 4) == 4 && read(clnt.get_fd(), buf, 4) == 4) {
+                        ++echoed;
+                    }
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        recs.root()->post([&recs] { recs.root()->destroy(); });
+    });
+    recs.activate();
+    root.join();
+    std::cout << "reuseport: " << reuseport << " steering: " << steering << " echoed: " << echoed << " accepted:";
+    int total = 0;
+    int active = 0;
+    for (auto& n : accepted) {
+        std::cout << " " << n;
+        total += n;
+        active += n > 0;
+    }
+    std::cout << std::endl;
+    assert(echoed == clients * conns && total == clients * conns);
+    if (!steering) {
+        assert(active == nodes);  // 按四元组哈希或轮询分配到所有节点
+    }
+}
+
+// 根节点按分发策略转交连接，服务端回复连接所在节点的下标
+void test_dispatch(net::dispatch_t policy, int port) {
+    net::creactors recs;
+    net::tcp_serv_socket sock;
+    net::set_reuse_address(sock.get_fd());
+    sock.listen_req("127.0.0.1", port);
+    recs.bind_serv_socket(std::move(sock));
+    recs.init_async_nodes(nodes);
+    recs.set_dispatch(policy);
+
+    std::vector<net::reactor*> workers;
+    for (int i = 0; i < nodes; ++i) {
+        workers.push_back(recs[i]);
+    }
+    recs.set_message_cb([&](net::reactor* rec, net::connection* conn) {
+        conn->input()->retrieve_all();
+        char idx = 0;
+        while (workers[idx] != rec) {
+            ++idx;
+        }
+        rec->send(conn, &idx, 1);
+    });
+
+    // 建立连接并返回其所在的节点
+    auto open = [port](std::vector<std::unique_ptr<net::tcp_clnt_socket>>& held) {
+        held.emplace_back(new net::tcp_clnt_socket());
+        held.back()->launch_req("127.0.0.1", port);
+        char idx = -1;
+        assert(write(held.back()->get_fd(), "?", 1) == 1 && read(held.back()->get_fd(), &idx, 1) == 1);
+        return static_cast<int>(idx);
+    };
+    int placed[nodes] = {};
+    bool balanced = true;
+    std::thread root([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        std::vector<std::unique_ptr<net::tcp_clnt_socket>> kept;
+        std::vector<std::unique_ptr<net::tcp_clnt_socket>> closed;
+        if (policy == net::dispatch::least_connections) {
+            // 只保留节点0上的连接，其余节点的连接关闭后新连接不应再交给节点0
+            for (int i = 0; i < 2 * nodes; ++i) {
+                std::vector<std::unique_ptr<net::tcp_clnt_socket>> tmp;
+                int idx = open(tmp);
+                ++placed[idx];
+                (idx == 0 ? kept : closed).push_back(std::move(tmp.back()));
+            }
+            closed.clear();
+            for (int i = 1; i < nodes; ++i) {
+                while (recs.node_load(i) != 0) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+            for (int i = 0; i < 2 * (nodes - 1); ++i) {
+                int idx = open(kept);
+                ++placed[idx];
+                balanced = balanced && idx != 0;
+            }
+        } else {
+            for (int i = 0; i < 10 * nodes; ++i) {
+                ++placed[open(kept)];
+            }
+        }
+        recs.root()->post([&recs] { recs.root()->destroy(); });
+    });
+    recs.activate();
+    root.join();
+    std::cout << "dispatch: " << static_cast<int>(policy) << " placed:";
+    int total = 0;
+    int active = 0;
+    for (int n : placed) {
+        std::cout << " " << n;
+        total += n;
+        active += n > 0;
+    }
+    std::cout << std::endl;
+    if (policy == net::dispatch::least_connections) {
+        assert(total == 2 * nodes + 2 * (nodes - 1) && balanced);
+    } else if (policy == net::dispatch::consistent_hash) {
+        assert(total == 10 * nodes && active == 1);  // 同一客户端地址总是同一节点
+    } else {
+        assert(total == 10 * nodes && active > 1);
+    }
+}
+
+// 根节点接受连接时fd耗尽(EMFILE)，ET模式的监听套接字不会再通知，释放fd后应在定时重试中接受
+void test_accept_emfile(int port) {
+    net::creactors recs;
+    net::tcp_serv_socket sock;
+    net::set_reuse_address(sock.get_fd());
+    sock.listen_req("127.0.0.1", port);
+    recs.bind_serv_socket(std::move(sock));
+    recs.init_async_nodes(nodes);
+    recs.set_message_cb([](net::reactor* rec, net::connection* conn) {
+        auto* in = conn->input();
+        rec->send(conn, in->peek(), in->readable_bytes());
+        in->retrieve_all();
+    });
+
+    struct rlimit old;
+    assert(getrlimit(RLIMIT_NOFILE, &old) == 0);
+    int echoed = 0;
+    std::thread root([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        std::vector<std::unique_ptr<net::tcp_clnt_socket>> clnts;
+        for (int i = 0; i < clients; ++i) {
+            clnts.emplace_back(new net::tcp_clnt_socket());
+        }
+        struct rlimit low = old;
+        low.rlim_cur = 256;
+        assert(setrlimit(RLIMIT_NOFILE, &low) == 0);
+        std::vector<int> fillers;
+        for (int fd; (fd = dup(0)) >= 0;) {  // 占满fd表
+            fillers.push_back(fd);
+        }
+        for (auto& c : clnts) {
+            c->launch_req("127.0.0.1", port);  // 握手由内核完成，连接留在全连接队列中
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        for (int fd : fillers) {
+            close(fd);
+        }
+        assert(setrlimit(RLIMIT_NOFILE, &old) == 0);
+        for (auto& c : clnts) {
+            struct timeval tv = {1, 0};
+            setsockopt(c->get_fd(), SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+            char buf[4];
+            if (write(c->get_fd(), "ping", 4) == 4 && read(c->get_fd(), buf, 4) == 4) {
+                ++echoed;
+            }
+        }
+        recs.root()->post([&recs] { recs.root()->destroy(); });
+    });
+    recs.activate();
+    root.join();
+    std::cout << "emfile echoed: " << echoed << std::endl;
+    assert(echoed == clients);
+}
+
+int main() {
+    test_accept(net::backend::epoll, true, false, 9096);
+    test_accept(net::backend::epoll, true, true, 9096);
+    test_accept(net::backend::uring, true, false, 9096);
+    test_accept(net::backend::epoll, false, false, 9096);
+    test_accept(net::backend::uring, false, false, 9096);
+    test_accept(net::backend::epoll, true, false, 9096);
+    test_dispatch(net::dispatch::least_connections, 9101);
+    test_dispatch(net::dispatch::p2c_connections, 9102);
+    test_dispatch(net::dispatch::consistent_hash, 9103);
+    test_accept_emfile(9112);
+}
@@ -0,0 +1,144 @@
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "nancy/net/creactors.h"
+using namespace nc;
+
+// ================================================================================
+//         连接迁移: 连接连同回调与缓冲区在节点间迁移，以及按负载自动再平衡
+// ================================================================================
+
+const int nodes = 2;
+
+// 以行为单位处理请求，回复"<节点下标><行内容>\n"；"m"使连接迁移到另一个节点
+void serve(net::creactors& recs, std::vector<net::reactor*>& workers, std::atomic<int>& closed) {
+    for (int i = 0; i < nodes; ++i) {
+        workers.push_back(recs[i]);
+    }
+    recs.set_message_cb([&recs, &workers, &closed](net::reactor* rec, net::connection* conn) {
+        conn->set_close_cb([&closed](net::connection*) { ++closed; });
+        int idx = 0;
+        while (workers[idx] != rec) {
+            ++idx;
+        }
+        auto* in = conn->input();
+        for (;;) {
+            std::string data(in->peek(), in->readable_bytes());
+            size_t end = data.find('\n');
+            if (end == std::string::npos) {
+                return;  // 不完整的行留在输入缓冲区
+            }
+            in->retrieve(end + 1);
+            std::string reply = std::to_string(idx) + data.substr(0, end) + "\n";
+            rec->send(conn, reply.data(), reply.size());
+            if (data.substr(0, end) == "m") {
+                assert(recs.migrate(rec, conn, (idx + 1) % nodes));
+                // 回调返回前连接不会被目标节点接管，目标节点的线程此时有机会运行
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                assert(conn->get_reactor() == rec);
+                return;  // 此后不再使用conn
+            }
+        }
+    });
+}
+
+std::string request(net::tcp_clnt_socket& clnt, const char* req) {
+    assert(write(clnt.get_fd(), req, strlen(req)) == static_cast<ssize_t>(strlen(req)));
+    std::string line;
+    char c;
+    while (read(clnt.get_fd(), &c, 1) == 1 && c != '\n') {
+        line.push_back(c);
+    }
+    return line;
+}
+
+// 迁移保留未消费的输入、待发送的输出与关闭回调
+void test_migrate(net::backend_t engine, int port) {
+    net::creactors recs(engine);
+    net::tcp_serv_socket sock;
+    net::set_reuse_address(sock.get_fd());
+    sock.listen_req("127.0.0.1", port);
+    recs.bind_serv_socket(std::move(sock));
+    recs.init_async_nodes(nodes);
+    std::vector<net::reactor*> workers;
+    std::atomic<int> closed = {0};
+    serve(recs, workers, closed);
+
+    std::vector<std::string> replies;
+    std::thread client([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        {
+            net::tcp_clnt_socket clnt;
+            clnt.launch_req("127.0.0.1", port);
+            replies.push_back(request(clnt, "a\n"));
+            replies.push_back(request(clnt, "m\npar"));  // "par"在迁移时留在输入缓冲区
+            replies.push_back(request(clnt, "t\n"));
+            replies.push_back(request(clnt, "m\n"));
+            replies.push_back(request(clnt, "b\n"));
+        }
+        while (closed == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        recs.root()->post([&recs] { recs.root()->destroy(); });
+    });
+    recs.activate();
+    client.join();
+    for (auto& r : replies) {
+        std::cout << r << " ";
+    }
+    std::cout << "closed: " << closed << std::endl;
+    char first = replies[0][0];
+    char second = first == '0' ? '1' : '0';
+    assert(replies[1] == std::string(1, first) + "m");
+    assert(replies[2] == std::string(1, second) + "part");
+    assert(replies[3] == std::string(1, second) + "m");
+    assert(replies[4] == std::string(1, first) + "b");
+    assert(closed == 1);
+}
+
+// 所有连接先落在同一节点，自动再平衡后两个节点各占一半
+void test_rebalance(int port) {
+    const int conns = 8;
+    net::creactors recs;
+    net::tcp_serv_socket sock;
+    net::set_reuse_address(sock.get_fd());
+    sock.listen_req("127.0.0.1", port);
+    recs.bind_serv_socket(std::move(sock));
+    recs.init_async_nodes(nodes);
+    recs.set_dispatch(net::dispatch::consistent_hash);
+    recs.set_rebalance(20);
+    std::vector<net::reactor*> workers;
+    std::atomic<int> closed = {0};
+    serve(recs, workers, closed);
+
+    int before[nodes] = {};
+    int after[nodes] = {};
+    std::thread client([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        std::vector<std::unique_ptr<net::tcp_clnt_socket>> clnts;
+        for (int i = 0; i < conns; ++i) {
+            clnts.emplace_back(new net::tcp_clnt_socket());
+            clnts.back()->launch_req("127.0.0.1", port);
+            ++before[request(*clnts.back(), "x\n")[0] - '0'];
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        for (auto& c : clnts) {
+            ++after[request(*c, "y\n")[0] - '0'];
+        }
+        recs.root()->post([&recs] { recs.root()->destroy(); });
+    });
+    recs.activate();
+    client.join();
+    std::cout << "before: " << before[0] << " " << before[1] << " after: " << after[0] << " " << after[1] << std::endl;
+    assert(before[0] == conns || before[1] == conns);
+    assert(after[0] == conns / 2 && after[1] == conns / 2);
+}
+
+int main() {
+    test_migrate(net::backend::epoll, 9106);
+    test_migrate(net::backend::uring, 9108);
+    test_rebalance(9107);
+}
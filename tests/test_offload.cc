@@ -0,0 +1,103 @@
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "nancy/net/creactors.h"
+using namespace nc;
+
+// ================================================================================
+//         计算任务卸载: 工作窃取线程池执行任务，结果按连接内的提交顺序交回节点
+// ================================================================================
+
+const int port = 9105;
+const int nodes = 2;
+const int messages = 10;
+
+// 工作线程提交的子任务进入自己的队列，由空闲线程窃取
+void test_pool() {
+    std::atomic<int> sum = {0};
+    {
+        details::work_stealing_pool pool(4);
+        for (int i = 0; i < 10; ++i) {
+            pool.submit([&pool, &sum] {
+                for (int j = 0; j < 100; ++j) {
+                    pool.submit([&sum] { ++sum; });
+                }
+            });
+        }
+    }  // 析构时执行完所有任务
+    std::cout << "pool sum: " << sum << std::endl;
+    assert(sum == 1000);
+}
+
+// 先提交的任务耗时更长，结果仍按提交顺序交付；计算期间节点继续响应其它连接
+void test_offload() {
+    net::creactors recs;
+    net::tcp_serv_socket sock;
+    net::set_reuse_address(sock.get_fd());
+    sock.listen_req("127.0.0.1", port);
+    recs.bind_serv_socket(std::move(sock));
+    recs.init_async_nodes(nodes);
+    recs.set_compute_threads(4);
+    recs.set_message_cb([&](net::reactor* rec, net::connection* conn) {
+        auto* in = conn->input();
+        for (; in->readable_bytes(); in->retrieve(1)) {
+            char c = *in->peek();
+            if (c == 'p') {  // 不经过线程池，直接回复
+                rec->send(conn, "p", 1);
+                continue;
+            }
+            if (c == '5') {  // 没有结果的任务
+                recs.offload(rec, conn, [] {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                }, [rec](net::connection* conn) {
+                    rec->send(conn, "5", 1);
+                });
+                continue;
+            }
+            recs.offload(rec, conn, [c] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5 * ('9' - c)));
+                return std::string(1, c);
+            }, [rec](net::connection* conn, std::string res) {
+                rec->send(conn, res.data(), res.size());
+            });
+        }
+    });
+
+    std::string got;
+    long ping_ms = 0;
+    std::thread client([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        net::tcp_clnt_socket heavy;
+        net::tcp_clnt_socket light[nodes];
+        heavy.launch_req("127.0.0.1", port);
+        for (auto& c : light) {  // 轮询分发，其中之一与heavy在同一节点
+            c.launch_req("127.0.0.1", port);
+        }
+        assert(write(heavy.get_fd(), "0123456789", messages) == messages);
+        auto start = std::chrono::steady_clock::now();
+        for (auto& c : light) {
+            char p;
+            assert(write(c.get_fd(), "p", 1) == 1 && read(c.get_fd(), &p, 1) == 1);
+        }
+        ping_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        char buf[messages];
+        ssize_t bytes = 0;
+        while (got.size() < messages && (bytes = read(heavy.get_fd(), buf, sizeof(buf))) > 0) {
+            got.append(buf, bytes);
+        }
+        recs.root()->post([&recs] { recs.root()->destroy(); });
+    });
+    recs.activate();
+    client.join();
+    std::cout << "offload results: " << got << " ping(ms): " << ping_ms << std::endl;
+    assert(got == "0123456789");
+    assert(ping_ms < 45);  // 远小于最长的计算任务
+}
+
+int main() {
+    test_pool();
+    test_offload();
+}
@@ -0,0 +1,76 @@
+#include <sys/socket.h>
+#include <cassert>
+#include <iostream>
+#include <thread>
+#include "nancy/net/reactor.h"
+using namespace nc;
+
+// ================================================================================
+//         reactor循环指标: 在其它线程中读取快照
+// ================================================================================
+
+uint64_t sum(const uint64_t* histogram, int buckets) {
+    uint64_t n = 0;
+    for (int i = 0; i < buckets; ++i) {
+        n += histogram[i];
+    }
+    return n;
+}
+
+void test_metrics(net::backend_t engine) {
+    const int messages = 1000;
+    net::reactor rec(-1, engine);
+    int sv[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+    net::set_nonblocking(sv[0]);
+
+    int received = 0;
+    int tasks = 0;
+    rec.add_socket(sv[0], net::event::readable, net::pattern::lt, [&](int fd) {
+        char c;
+        while (read(fd, &c, 1) == 1) {
+            ++received;
+        }
+    });
+    rec.run_after(20, [&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));  // 慢回调
+    });
+
+    std::thread producer([&] {
+        for (int i = 0; i < messages; ++i) {
+            assert(write(sv[1], "x", 1) == 1);
+            rec.post([&tasks] { ++tasks; });
+            auto m = rec.metrics();  // 与反应堆线程并发读取
+            assert(m.events <= m.wakeups * net::config::max_events);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        rec.destroy();
+    });
+    rec.activate();
+    producer.join();
+    close(sv[0]);
+    close(sv[1]);
+
+    auto m = rec.metrics();
+    auto& rd = m.callbacks[net::callback_kind::readable];
+    auto& task = m.callbacks[net::callback_kind::task];
+    auto& timer = m.callbacks[net::callback_kind::timer];
+    std::cout << "wakeups: " << m.wakeups << " events: " << m.events << " max batch: " << m.max_batch
+              << " readable: " << rd.calls << " task: " << task.calls
+              << " timer max(us): " << timer.max_ns / 1000 << " lag max(us): " << m.lag_max_us << std::endl;
+    assert(received == messages && tasks == messages);
+    assert(sum(m.batch_histogram, net::loop_metrics::batch_buckets) == m.wakeups);
+    assert(rd.calls > 0 && rd.calls == sum(rd.histogram, net::loop_metrics::latency_buckets));
+    assert(task.calls > 0);
+    assert(timer.calls == 1 && timer.max_ns >= 2000000 && m.lag_samples == 1);
+    uint64_t callbacks = 0;
+    for (auto& cb : m.callbacks) {
+        callbacks += cb.calls;
+    }
+    assert(callbacks == m.events + timer.calls);
+}
+
+int main() {
+    test_metrics(net::backend::epoll);
+    test_metrics(net::backend::uring);
+}
@@ -0,0 +1,215 @@
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <cassert>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "nancy/net/reactor.h"
+using namespace nc;
+
+// ================================================================================
+//         reactor混合轮询模式与自适应事件数组
+// ================================================================================
+
+// 进程占用的CPU时间(毫秒)
+long cpu_millis() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000 +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000;
+}
+
+// 大量fd同时就绪，事件数组需要多次扩容才能一轮取完
+void test_burst(net::backend_t engine) {
+    const int pairs = 500;
+    net::reactor rec(-1, engine);
+    std::vector<int> fds;
+    int readable = 0;
+    for (int i = 0; i < pairs; ++i) {
+        int sv[2];
+        assert(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+        assert(write(sv[1], "x", 1) == 1);
+        fds.push_back(sv[0]);
+        fds.push_back(sv[1]);
+        rec.add_socket(sv[0], net::event::readable, net::pattern::lt, [&](int fd) {
+            char c;
+            assert(read(fd, &c, 1) == 1);
+            if (++readable == pairs) {
+                rec.destroy();
+            }
+        });
+    }
+    rec.activate();
+    for (int fd : fds) {
+        close(fd);
+    }
+    std::cout << "burst readable: " << readable << std::endl;
+    assert(readable == pairs);
+}
+
+// 轮询模式下事件正常送达，空闲后回到阻塞等待而不持续占用CPU
+void test_busy_poll(net::backend_t engine) {
+    net::reactor rec(-1, engine);
+    rec.set_busy_poll(2000);
+    int executed = 0;
+    long cpu = 0;
+    std::thread producer([&] {
+        for (int i = 0; i < 100; ++i) {
+            rec.post([&executed] { ++executed; });
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        long start = cpu_millis();
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        cpu = cpu_millis() - start;
+        rec.destroy();
+    });
+    rec.activate();
+    producer.join();
+    std::cout << "busy poll executed: " << executed << " idle cpu(ms): " << cpu << std::endl;
+    assert(executed == 100);
+    assert(cpu < 100);
+}
+
+// 轮询期间关闭轮询模式，循环回到阻塞等待
+void test_busy_poll_off(net::backend_t engine) {
+    net::reactor rec(-1, engine);
+    rec.set_busy_poll(10 * 1000 * 1000);
+    long cpu = 0;
+    std::thread producer([&] {
+        rec.post([] {});  // 有事件后进入轮询
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        rec.post([&rec] { rec.set_busy_poll(0); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        long start = cpu_millis();
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        cpu = cpu_millis() - start;
+        rec.destroy();
+    });
+    rec.activate();
+    producer.join();
+    std::cout << "busy poll off idle cpu(ms): " << cpu << std::endl;
+    assert(cpu < 100);
+}
+
+// ET模式下的读取预算: 快速发送方读满预算后让出，其它fd无需等它读完即可被处理
+void test_fairness(net::backend_t engine) {
+    const size_t budget = 4096;
+    const size_t flood = 1 << 20;
+    net::reactor rec(-1, engine);
+    rec.set_read_budget(budget);
+    int fast[2], slow[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, fast) == 0);
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, slow) == 0);
+    net::set_nonblocking(fast[0]);
+    net::set_nonblocking(fast[1]);
+    net::set_nonblocking(slow[0]);
+
+    std::vector<char> data(flood, 'f');
+    size_t written = 0;
+    size_t fast_read = 0;
+    size_t fast_read_at_slow = 0;
+    int rounds = 0;
+    rec.add_socket(fast[0], net::event::readable, net::pattern::et, [&](int fd) {
+        char buf[1024];
+        size_t total = 0;
+        ssize_t bytes = 0;
+        while (total < rec.get_read_budget() && (bytes = read(fd, buf, sizeof(buf))) > 0) {
+            total += bytes;
+        }
+        fast_read += total;
+        if (total >= rec.get_read_budget()) {
+            rec.requeue(fd);
+        }
+        if (++rounds == 3) {
+            assert(write(slow[1], "s", 1) == 1);  // 快速发送方仍有数据时，慢速连接的数据到达
+        }
+        // 持续补充数据
+        ssize_t n = 0;
+        while (written < flood && (n = write(fast[1], data.data() + written, flood - written)) > 0) {
+            written += n;
+        }
+        if (fast_read == flood) {
+            rec.destroy();
+        }
+    });
+    rec.add_socket(slow[0], net::event::readable, net::pattern::et, [&](int fd) {
+        char c;
+        assert(read(fd, &c, 1) == 1);
+        fast_read_at_slow = fast_read;
+    });
+    ssize_t n = write(fast[1], data.data(), flood);
+    written = n > 0 ? n : 0;
+    rec.activate();
+    for (int fd : {fast[0], fast[1], slow[0], slow[1]}) {
+        close(fd);
+    }
+    std::cout << "fairness rounds: " << rounds << " fast read when slow served: " << fast_read_at_slow << std::endl;
+    assert(fast_read == flood);
+    assert(fast_read_at_slow > 0 && fast_read_at_slow <= 4 * budget);
+}
+
+// receiver读满预算后自动让出，数据仍完整送达
+void test_receiver_budget() {
+    const size_t total = 1 << 20;
+    net::reactor rec;
+    rec.set_read_budget(16 * 1024);
+    int sv[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+    net::set_nonblocking(sv[0]);
+    size_t received = 0;
+    rec.add_receiver(sv[0], [&](int, const char*, ssize_t len) {
+        received += len > 0 ? len : 0;
+        if (received == total) {
+            rec.destroy();
+        }
+    });
+    std::thread writer([&] {
+        std::vector<char> data(total, 'r');
+        size_t sent = 0;
+        ssize_t n = 0;
+        while (sent < total && (n = write(sv[1], data.data() + sent, total - sent)) > 0) {
+            sent += n;
+        }
+    });
+    rec.activate();
+    writer.join();
+    close(sv[0]);
+    close(sv[1]);
+    std::cout << "receiver budget received: " << received << std::endl;
+    assert(received == total);
+}
+
+// 回调中关闭fd而未移除时，下一次读取的EBADF同样交给回调
+void test_receiver_closed() {
+    net::reactor rec;
+    int sv[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+    net::set_nonblocking(sv[0]);
+    ssize_t last = 0;
+    rec.add_receiver(sv[0], [&](int fd, const char*, ssize_t len) {
+        last = len;
+        if (len > 0) {
+            close(fd);
+        } else {
+            rec.destroy();
+        }
+    });
+    assert(write(sv[1], "x", 1) == 1);
+    rec.activate();
+    close(sv[1]);
+    std::cout << "receiver closed: " << last << std::endl;
+    assert(last == -EBADF);
+}
+
+int main() {
+    test_burst(net::backend::epoll);
+    test_burst(net::backend::uring);
+    test_busy_poll(net::backend::epoll);
+    test_busy_poll(net::backend::uring);
+    test_busy_poll_off(net::backend::epoll);
+    test_busy_poll_off(net::backend::uring);
+    test_fairness(net::backend::epoll);
+    test_fairness(net::backend::uring);
+    test_receiver_budget();
+    test_receiver_closed();
+}
@@ -0,0 +1,56 @@
+#include <signal.h>
+#include <unistd.h>
+#include <cassert>
+#include <iostream>
+#include <thread>
+#include "nancy/net/reactor.h"
+using namespace nc;
+
+// ================================================================================
+//         reactor信号: 每个反应堆各自的signalfd，回调携带siginfo
+// ================================================================================
+
+int main() {
+    // 在创建其它线程前注册，所有线程继承对这些信号的屏蔽
+    net::reactor first;
+    net::reactor second(-1, net::backend::uring);
+    int values = 0;
+    int usr2 = 0;
+    int term = 0;
+    first.add_signal(SIGUSR1, [&](const signalfd_siginfo& info) {
+        assert(info.ssi_pid == static_cast<uint32_t>(getpid()));
+        values += info.ssi_int;
+    });
+    first.add_signal(SIGUSR2, [&](int sig) {
+        assert(sig == SIGUSR2);
+        ++usr2;
+    });
+    second.add_signal(SIGTERM, [&](int) {
+        ++term;
+        second.destroy();
+    });
+
+    std::thread node([&] { second.activate(); });
+    std::thread sender([&] {
+        for (int i = 1; i <= 10; ++i) {  // 实时信号以外的信号会被合并，逐个等待送达
+            union sigval val;
+            val.sival_int = i;
+            assert(sigqueue(getpid(), SIGUSR1, val) == 0);
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        for (int i = 0; i < 100; ++i) {  // 突发的同一信号合并为一次或多次，但不会丢失最后一次
+            kill(getpid(), SIGUSR2);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        kill(getpid(), SIGTERM);  // 由另一个反应堆处理
+        first.post([&first] { first.remove_signal(SIGUSR2); });
+        first.post([&first] { first.run_after(20, [&first] { first.destroy(); }); });
+    });
+    first.activate();
+    sender.join();
+    node.join();
+    std::cout << "values: " << values << " usr2: " << usr2 << " term: " << term << std::endl;
+    assert(values == 55);
+    assert(usr2 >= 1 && usr2 <= 100);
+    assert(term == 1);
+}
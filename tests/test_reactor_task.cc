@@ -0,0 +1,68 @@
+#include <cassert>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "nancy/net/reactor.h"
+using namespace nc;
+
+// ================================================================================
+//         reactor跨线程任务: 多个线程通过post/run_in_loop向反应堆投递任务
+// ================================================================================
+
+// 根节点向工作节点转交连接使用的SPSC队列: 元素按序到达，队列满时push失败
+void test_spsc() {
+    const int total = 1000000;
+    nc::details::spsc_queue<int> queue(1000);
+    assert(queue.capacity() == 1024);
+    std::thread producer([&] {
+        for (int i = 0; i < total; ++i) {
+            while (!queue.push(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    int expect = 0;
+    bool ordered = true;
+    while (expect < total) {
+        queue.drain([&](int v) { ordered = ordered && v == expect++; });
+    }
+    producer.join();
+    assert(ordered);
+    for (int i = 0; i < 1024; ++i) {
+        assert(queue.push(i));
+    }
+    assert(!queue.push(0));
+    std::cout << "spsc ok" << std::endl;
+}
+
+int main() {
+    test_spsc();
+    const int producers = 4;
+    const int tasks_per_producer = 100000;
+
+    net::reactor rec;
+    int executed = 0;  // 只在反应堆线程中修改，无需加锁
+    bool in_loop = true;
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < producers; ++i) {
+        threads.emplace_back([&] {
+            for (int j = 0; j < tasks_per_producer; ++j) {
+                rec.run_in_loop([&] {
+                    in_loop = in_loop && rec.in_loop_thread();
+                    if (++executed == producers * tasks_per_producer) {
+                        rec.destroy();
+                    }
+                });
+            }
+        });
+    }
+    rec.activate();
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    assert(in_loop);
+    assert(executed == producers * tasks_per_producer);
+    std::cout << "executed " << executed << " tasks" << std::endl;
+}
@@ -0,0 +1,55 @@
+#include <cassert>
+#include <iostream>
+#include "nancy/net/reactor.h"
+using namespace nc;
+
+// ================================================================================
+//         reactor定时任务: run_after / run_every / cancel
+// ================================================================================
+
+int main() {
+    net::reactor rec;
+    int once = 0;
+    int every = 0;
+    int cancelled = 0;
+
+    rec.run_after(10, [&] { ++once; });
+    auto never = rec.run_after(20, [&] { ++cancelled; });
+    assert(rec.cancel(never));
+    assert(!rec.cancel(never));
+
+    net::timer_id tick = 0;
+    tick = rec.run_every(5, [&] {
+        std::cout << "tick " << ++every << std::endl;
+        if (every == 5) {
+            rec.cancel(tick);  // 在回调中取消自身
+        }
+    });
+
+    // 周期任务在回调中添加大量任务使容器重新哈希，之后仍按周期重新排期
+    int grown = 0;
+    int added = 0;
+    net::timer_id grow = 0;
+    grow = rec.run_every(5, [&] {
+        for (int i = 0; i < 1000; ++i) {
+            rec.run_after(1, [&] { ++added; });
+        }
+        if (++grown == 3) {
+            rec.cancel(grow);
+        }
+    });
+
+    // 持续产生可读事件，定时任务仍应按时触发
+    net::sockpair pair;
+    rec.add_socket(pair.get_rfd(), net::event::readable, net::pattern::lt, [&](int) {});
+    pair.write_lfd("x", 1);
+
+    rec.run_after(100, [&] { rec.destroy(); });
+    rec.activate();
+
+    assert(once == 1);
+    assert(every == 5);
+    assert(cancelled == 0);
+    assert(grown == 3 && added == 3000);
+    std::cout << "all timers done" << std::endl;
+}
@@ -0,0 +1,95 @@
+#include <cassert>
+#include <iostream>
+#include <thread>
+#include "nancy/net/reactor.h"
+using namespace nc;
+
+// ================================================================================
+//         reactor的epoll/io_uring后端: 同一套接口下的回声服务
+// ================================================================================
+
+const int port = 9091;
+const int conns = 100;
+const int rounds = 5;
+
+// 通过客户端线程发送并校验回声，结束后关闭反应堆
+int run_clients(net::reactor& rec) {
+    int echoed = 0;
+    std::thread clients([&] {
+        for (int i = 0; i < conns; ++i) {
+            net::tcp_clnt_socket clnt;
+            clnt.launch_req("127.0.0.1", port);
+            for (int j = 0; j < rounds; ++j) {
+                char buf[8];
+                assert(write(clnt.get_fd(), "nancy", 5) == 5);
+                if (read(clnt.get_fd(), buf, sizeof(buf)) == 5) {
+                    ++echoed;
+                }
+            }
+        }
+        rec.destroy();
+    });
+    rec.activate();
+    clients.join();
+    return echoed;
+}
+
+// 就绪回调: add_socket + set_readable_cb
+void test_readiness(net::backend_t engine) {
+    net::reactor rec(-1, engine);
+    net::tcp_serv_socket serv;
+    net::set_reuse_address(serv.get_fd());
+    net::set_nonblocking(serv.get_fd());
+    serv.listen_req("127.0.0.1", port);
+
+    rec.add_socket(serv.get_fd(), net::event::readable, net::pattern::et, [&](int) {
+        int fd = 0;
+        while ((fd = serv.accept_req()) > 0) {
+            net::set_nonblocking(fd);
+            rec.add_socket(fd, net::event::readable, net::pattern::lt);
+        }
+    });
+    rec.set_readable_cb([](int fd) {
+        char buf[64];
+        int bytes = read(fd, buf, sizeof(buf));
+        if (bytes > 0) {
+            assert(write(fd, buf, bytes) == bytes);
+        }
+    });
+    rec.set_disconnect_cb([&rec](int fd) {
+        rec.remove_socket(fd);
+        close(fd);
+    });
+    int echoed = run_clients(rec);
+    std::cout << "readiness echoed: " << echoed << std::endl;
+    assert(echoed == conns * rounds);
+}
+
+// 完成回调: add_acceptor + add_receiver
+void test_completion(net::backend_t engine) {
+    net::reactor rec(-1, engine);
+    net::tcp_serv_socket serv;
+    net::set_reuse_address(serv.get_fd());
+    serv.listen_req("127.0.0.1", port);
+
+    rec.add_acceptor(serv.get_fd(), [&rec](int conn) {
+        rec.add_receiver(conn, [&rec](int fd, const char* data, ssize_t len) {
+            if (len > 0) {
+                assert(write(fd, data, len) == len);
+            } else {
+                rec.remove_socket(fd);
+                close(fd);
+            }
+        });
+    });
+    int echoed = run_clients(rec);
+    std::cout << "completion echoed: " << echoed << std::endl;
+    assert(echoed == conns * rounds);
+}
+
+int main() {
+    test_readiness(net::backend::epoll);
+    test_completion(net::backend::epoll);
+    test_readiness(net::backend::uring);
+    test_completion(net::backend::uring);
+}
@@ -0,0 +1,89 @@
+#include <fcntl.h>
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "nancy/net/reactor.h"
+using namespace nc;
+
+// ================================================================================
+//         connection::send_file: 文件/管道数据经sendfile/splice发送，并与缓冲数据保持顺序
+// ================================================================================
+
+const int port = 9095;
+const size_t file_size = 4 << 20;  // 4MB，远超套接字发送缓冲区
+const size_t offset = 100;
+const size_t pipe_size = 32 * 1024;
+
+std::string make_content(size_t n, char base) {
+    std::string s(n, 0);
+    for (size_t i = 0; i < n; ++i) {
+        s[i] = static_cast<char>(base + i % 26);
+    }
+    return s;
+}
+
+void test_send_file(net::backend_t engine, int file_fd, const std::string& content) {
+    net::reactor rec(-1, engine);
+    net::tcp_serv_socket serv;
+    net::set_reuse_address(serv.get_fd());
+    net::set_nonblocking(serv.get_fd());
+    serv.listen_req("127.0.0.1", port);
+
+    int done = 0;
+    std::string piped = make_content(pipe_size, 'A');
+    rec.add_socket(serv.get_fd(), net::event::readable, net::pattern::et, [&](int) {
+        int fd = 0;
+        while ((fd = serv.accept_req()) > 0) {
+            net::set_nonblocking(fd);
+            rec.add_connection(fd, [&](net::connection* conn) {
+                conn->input()->retrieve_all();
+                int pipefd[2];
+                assert(pipe(pipefd) == 0);
+                assert(write(pipefd[1], piped.data(), pipe_size) == static_cast<ssize_t>(pipe_size));
+                rec.send(conn, "HEAD", 4);
+                assert(rec.send_file(conn, file_fd, offset, file_size - offset, [&done] { ++done; }));
+                rec.send(conn, "MID", 3);
+                assert(rec.send_file(conn, pipefd[0], 0, pipe_size, [&done, pipefd] {
+                    ++done;
+                    close(pipefd[0]);
+                    close(pipefd[1]);
+                }));
+                rec.send(conn, "TAIL", 4);
+                assert(!rec.send_file(conn, serv.get_fd(), 0, 1));  // 不支持的描述符类型
+            });
+        }
+    });
+
+    std::string expect = "HEAD" + content.substr(offset) + "MID" + piped + "TAIL";
+    std::string got;
+    std::thread client([&] {
+        net::tcp_clnt_socket clnt;
+        clnt.launch_req("127.0.0.1", port);
+        assert(write(clnt.get_fd(), "?", 1) == 1);
+        char buf[65536];
+        ssize_t bytes = 0;
+        while (got.size() < expect.size() && (bytes = read(clnt.get_fd(), buf, sizeof(buf))) > 0) {
+            got.append(buf, bytes);
+        }
+        rec.post([&rec] { rec.destroy(); });
+    });
+    rec.activate();
+    client.join();
+    std::cout << "received: " << got.size() << " done: " << done << std::endl;
+    assert(got == expect);
+    assert(done == 2);
+}
+
+int main() {
+    char path[] = "/tmp/nancy_send_file_XXXXXX";
+    int file_fd = mkstemp(path);
+    assert(file_fd != -1);
+    unlink(path);
+    std::string content = make_content(file_size, 'a');
+    assert(write(file_fd, content.data(), file_size) == static_cast<ssize_t>(file_size));
+
+    test_send_file(net::backend::epoll, file_fd, content);
+    test_send_file(net::backend::uring, file_fd, content);
+    close(file_fd);
+}
@@ -0,0 +1,120 @@
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "nancy/net/reactor.h"
+using namespace nc;
+
+// ================================================================================
+//         UDP: recvmmsg批量接收，sendmmsg批量发送，UDP_SEGMENT/UDP_GRO分段与合并
+// ================================================================================
+
+const int bursts = 64;
+const int burst_size = 64;
+const int gso_chunks = 20;
+const size_t segment = 1000;
+const size_t chunk = segment * 40 + 300;  // 最后一个分段较短
+
+void test_udp(net::backend_t engine) {
+    net::reactor rec(-1, engine);
+    net::udp_socket serv;
+    serv.bind_req("127.0.0.1", 0);
+    net::set_recv_bufsz(serv.get_fd(), 4 << 20);
+    bool gro = serv.enable_gro();
+    struct sockaddr_in serv_addr = serv.local_addr();
+
+    const int small_total = bursts * burst_size;
+    const int gso_total = gso_chunks * (chunk / segment + 1);
+    int small = 0;
+    int segments = 0;
+    int bad = 0;
+    rec.add_datagram_receiver(serv.get_fd(), [&](int fd, const char* data, size_t len, const struct sockaddr_in& peer) {
+        if (data[0] == 's') {
+            bad += len != 100;
+            ++small;
+        } else {
+            bad += len != segment && len != chunk % segment;
+            ++segments;
+        }
+        if (small + segments == small_total + gso_total) {
+            assert(sendto(fd, "done", 4, 0, (const struct sockaddr*)&peer, sizeof(peer)) == 4);
+            rec.destroy();
+        }
+    });
+
+    bool done = false;
+    std::thread client([&] {
+        net::udp_socket clnt;
+        clnt.connect_req("127.0.0.1", ntohs(serv_addr.sin_port));
+        std::vector<char> payload(chunk, 'g');
+        char small_data[100];
+        memset(small_data, 's', sizeof(small_data));
+        std::vector<net::datagram> dgs(burst_size, net::datagram{small_data, sizeof(small_data), nullptr});
+        for (int i = 0; i < bursts; ++i) {
+            int sent = 0;
+            while (sent < burst_size) {
+                int ret = clnt.send_batch(dgs.data() + sent, burst_size - sent);
+                sent += ret > 0 ? ret : 0;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+        }
+        for (int i = 0; i < gso_chunks; ++i) {
+            assert(clnt.send_segments(payload.data(), chunk, segment) == static_cast<ssize_t>(chunk));
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+        }
+        char buf[16];
+        for (int i = 0; i < 300 && !done; ++i) {  // 等待服务端应答，丢包时由超时结束
+            done = read(clnt.get_fd(), buf, sizeof(buf)) == 4;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        rec.post([&rec] { rec.destroy(); });
+    });
+    rec.activate();
+    client.join();
+    rec.remove_socket(serv.get_fd());
+    std::cout << "gro: " << gro << " small: " << small << " segments: " << segments << " bad: " << bad << std::endl;
+    assert(done && small == small_total && segments == gso_total && bad == 0);
+}
+
+// 已连接的套接字上挂起ICMP端口不可达(ECONNREFUSED)时，其后到达的数据报仍被读取
+void test_pending_error(net::backend_t engine) {
+    const int nums = 3;
+    int peer_port = 0;
+    {
+        net::udp_socket closed;
+        closed.bind_req("127.0.0.1", 0);
+        peer_port = ntohs(closed.local_addr().sin_port);
+    }
+    net::udp_socket serv;
+    serv.bind_req("127.0.0.1", 0);
+    serv.connect_req("127.0.0.1", peer_port);
+    assert(write(serv.get_fd(), "x", 1) == 1);  // 对端端口已关闭
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    net::udp_socket peer;
+    peer.bind_req("127.0.0.1", peer_port);
+    peer.connect_req("127.0.0.1", ntohs(serv.local_addr().sin_port));
+    for (int i = 0; i < nums; ++i) {
+        assert(write(peer.get_fd(), "d", 1) == 1);
+    }
+
+    net::reactor rec(-1, engine);
+    int received = 0;
+    rec.add_datagram_receiver(serv.get_fd(), [&](int, const char*, size_t, const struct sockaddr_in&) {
+        if (++received == nums) {
+            rec.destroy();
+        }
+    });
+    rec.run_after(500, [&rec] { rec.destroy(); });
+    rec.activate();
+    rec.remove_socket(serv.get_fd());
+    std::cout << "received after pending error: " << received << std::endl;
+    assert(received == nums);
+}
+
+int main() {
+    test_udp(net::backend::epoll);
+    test_udp(net::backend::uring);
+    test_pending_error(net::backend::epoll);
+    test_pending_error(net::backend::uring);
+}
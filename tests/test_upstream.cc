@@ -0,0 +1,246 @@
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "nancy/net/upstream.h"
+using namespace nc;
+
+// ================================================================================
+//         非阻塞连接与上游连接池: 连接完成/失败/超时回调，空闲连接的复用与淘汰
+// ================================================================================
+
+const int port = 9109;
+const int full_port = 9110;  // 全连接队列已满、不再响应SYN的端口
+
+// 回显服务端，记录接受的连接数
+struct echo_server {
+    net::reactor rec;
+    net::tcp_serv_socket sock;
+    std::atomic<int> accepted = {0};
+    std::thread thrd;
+
+    echo_server() {
+        net::set_reuse_address(sock.get_fd());
+        sock.listen_req("127.0.0.1", port);
+        rec.add_acceptor(sock.get_fd(), [this](int fd) {
+            ++accepted;
+            rec.add_connection(fd, [this](net::connection* conn) {
+                auto* in = conn->input();
+                rec.send(conn, in->peek(), in->readable_bytes());
+                in->retrieve_all();
+            });
+        });
+        thrd = std::thread([this] { rec.activate(); });
+    }
+    ~echo_server() {
+        rec.post([this] { rec.destroy(); });
+        thrd.join();
+    }
+};
+
+void test_launch_error() {
+    net::tcp_clnt_socket clnt;
+    bool thrown = false;
+    try {
+        clnt.launch_req("127.0.0.1", port);  // 没有监听者
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+void test_async_connect() {
+    // 队列长度为0的监听者在接受一个连接后不再响应SYN
+    net::tcp_serv_socket full;
+    net::set_reuse_address(full.get_fd());
+    full.listen_req("127.0.0.1", full_port, 0);
+    std::vector<std::unique_ptr<net::tcp_clnt_socket>> fillers;
+    for (int i = 0; i < 4; ++i) {
+        fillers.emplace_back(new net::tcp_clnt_socket());
+        fillers.back()->launch_async_req("127.0.0.1", full_port);
+    }
+
+    echo_server server;
+    net::reactor rec;
+    int refused = 0, timed_out = 0, echoed = 0;
+    rec.async_connect("127.0.0.1", port + 100, 1000, [&](int fd, int err) {
+        assert(fd == -1);
+        refused = err == ECONNREFUSED;
+    });
+    rec.async_connect("127.0.0.1", full_port, 100, [&](int fd, int err) {
+        assert(fd == -1);
+        timed_out = err == ETIMEDOUT;
+    });
+    rec.async_connect("127.0.0.1", port, 1000, [&](int fd, int err) {
+        assert(fd >= 0 && err == 0);
+        auto* conn = rec.add_connection(fd, [&](net::connection* conn) {
+            echoed += conn->input()->readable_bytes();
+            conn->input()->retrieve_all();
+            rec.run_after(200, [&rec] { rec.destroy(); });
+        });
+        rec.send(conn, "ping", 4);
+    });
+    rec.activate();
+    std::cout << "refused: " << refused << " timed out: " << timed_out << " echoed: " << echoed << std::endl;
+    assert(refused && timed_out && echoed == 4);
+}
+
+// fd被直接关闭而未从反应堆移除，其号码被新套接字复用时，async_connect与wait_event仍能注册
+void test_stale_fd() {
+    echo_server server;
+    net::reactor rec;
+    int sv[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+    rec.add_socket(sv[0], net::event::readable, net::pattern::lt, [](int) {});
+    rec.add_socket(sv[1], net::event::readable, net::pattern::lt, [](int) {});
+    close(sv[0]);
+    close(sv[1]);
+    int connected = -1, writable = -1;
+    rec.async_connect("127.0.0.1", port, 1000, [&](int fd, int err) {
+        assert(fd >= 0 && err == 0);
+        connected = fd;
+        close(fd);
+        int reused[2];
+        assert(socketpair(AF_UNIX, SOCK_STREAM, 0, reused) == 0);
+        int target = reused[0] == sv[1] ? reused[0] : reused[1];  // 仍残留着上下文的fd号
+        rec.wait_event(target, net::event::writable, [&](int fd) {
+            writable = fd;
+            rec.destroy();
+            rec.remove_socket(fd);  // 本回调随之析构，放在最后
+        });
+        rec.run_after(1000, [&rec] { rec.destroy(); });
+        close(reused[0] == target ? reused[1] : reused[0]);
+    });
+    rec.activate();
+    std::cout << "stale fds: " << sv[0] << "," << sv[1] << " connected: " << connected << " writable: " << writable
+              << std::endl;
+    assert(connected == sv[0] && writable == sv[1]);
+    close(writable);
+}
+
+void test_pool() {
+    echo_server server;
+    net::reactor rec;
+    net::upstream_pool pool(&rec, 1, 100);
+    std::vector<int> fds;
+    int replies = 0;
+    // 发送一次请求，收到回复后归还
+    std::function<void(net::connection*, std::function<void()>)> call = [&](net::connection* conn, std::function<void()> next) {
+        fds.push_back(conn->get_fd());
+        conn->set_message_cb([&, next](net::connection* c) {
+            ++replies;
+            pool.release(c);
+            next();
+        });
+        rec.send(conn, "q", 1);
+    };
+    auto finish = [&] { rec.destroy(); };
+    auto after_idle = [&] {  // 空闲超时后重新建立连接
+        rec.run_after(400, [&] {
+            assert(pool.idle_nums("127.0.0.1", port) <= 1);
+            pool.acquire("127.0.0.1", port, [&](net::connection* conn, int err) {
+                assert(conn && !err);
+                call(conn, finish);
+            });
+        });
+    };
+    auto concurrent = [&] {  // 同时取得两个连接，归还时超出max_idle的一个被关闭
+        pool.acquire("127.0.0.1", port, [&](net::connection* first, int) {
+            pool.acquire("127.0.0.1", port, [&, first](net::connection* second, int) {
+                assert(first != second);
+                call(first, [] {});
+                call(second, after_idle);
+            });
+        });
+    };
+    auto again = [&] {  // 复用刚归还的连接
+        pool.acquire("127.0.0.1", port, [&](net::connection* conn, int err) {
+            assert(conn && !err && pool.reused_nums() == 1);
+            call(conn, concurrent);
+        });
+    };
+    pool.acquire("127.0.0.1", port, [&](net::connection* conn, int err) {
+        assert(conn && !err);
+        call(conn, again);
+    });
+    rec.activate();
+    std::cout << "replies: " << replies << " created: " << pool.created_nums() << " reused: " << pool.reused_nums()
+              << " accepted: " << server.accepted << std::endl;
+    assert(replies == 5);
+    assert(fds[0] == fds[1] && fds[1] == fds[2]);
+    assert(pool.created_nums() == 3 && pool.reused_nums() == 2);  // 新建: 第一个、并发的第二个、空闲超时后的连接
+    assert(server.accepted == 3);
+}
+
+// 主动健康检查关闭失败的空闲连接
+void test_health_check() {
+    echo_server server;
+    net::reactor rec;
+    net::upstream_pool pool(&rec);
+    int checked = 0;
+    pool.set_health_check(20, [&](net::connection*) {
+        ++checked;
+        return false;
+    });
+    pool.acquire("127.0.0.1", port, [&](net::connection* conn, int) {
+        pool.release(conn);
+        assert(pool.idle_nums("127.0.0.1", port) == 1);
+        rec.run_after(100, [&] {
+            pool.acquire("127.0.0.1", port, [&](net::connection* conn, int) {
+                assert(conn);
+                rec.destroy();
+            });
+        });
+    });
+    rec.activate();
+    std::cout << "checked: " << checked << " created: " << pool.created_nums() << std::endl;
+    assert(checked == 1 && pool.created_nums() == 2);
+}
+
+// 探测请求的回显交给回复检查函数，连接在检查后仍可被复用
+void test_health_probe() {
+    echo_server server;
+    net::reactor rec;
+    net::upstream_pool pool(&rec);
+    int probed = 0;
+    int replied = 0;
+    pool.set_health_check(
+        20,
+        [&](net::connection* conn) {
+            ++probed;
+            rec.send(conn, "ping", 4);
+            return true;
+        },
+        [&](net::connection* conn) {
+            if (conn->input()->readable_bytes() < 4) {
+                return true;  // 等待完整的回复
+            }
+            ++replied;
+            return conn->input()->retrieve_as_string(4) == "ping";
+        });
+    pool.acquire("127.0.0.1", port, [&](net::connection* conn, int) {
+        pool.release(conn);
+        rec.run_after(110, [&] {
+            assert(pool.idle_nums("127.0.0.1", port) == 1);
+            pool.acquire("127.0.0.1", port, [&](net::connection* conn, int) {
+                assert(conn);
+                rec.destroy();
+            });
+        });
+    });
+    rec.activate();
+    std::cout << "probed: " << probed << " replied: " << replied << " created: " << pool.created_nums()
+              << " reused: " << pool.reused_nums() << std::endl;
+    assert(probed >= 3 && replied >= 3 && pool.created_nums() == 1 && pool.reused_nums() == 1);
+}
+
+int main() {
+    test_launch_error();
+    test_async_connect();
+    test_stale_fd();
+    test_pool();
+    test_health_check();
+    test_health_probe();
+}
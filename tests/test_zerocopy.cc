@@ -0,0 +1,85 @@
+#include <cassert>
+#include <iostream>
+#include <thread>
+#include "nancy/net/reactor.h"
+using namespace nc;
+
+// ================================================================================
+//         connection零拷贝发送: 用户缓冲区在内核完成通知后释放
+// ================================================================================
+
+const int port = 9094;
+const int requests = 200;
+const size_t block = 64 * 1024;
+
+void test_zerocopy(net::backend_t engine) {
+    net::reactor rec(-1, engine);
+    net::tcp_serv_socket serv;
+    net::set_reuse_address(serv.get_fd());
+    net::set_nonblocking(serv.get_fd());
+    serv.listen_req("127.0.0.1", port);
+
+    std::unique_ptr<char[]> data(new char[block]);
+    for (size_t i = 0; i < block; ++i) {
+        data[i] = static_cast<char>('a' + i % 26);
+    }
+    int sent = 0;
+    int released = 0;
+    int small_released = 0;
+    int inflight = 0;  // 发送后仍在等待完成通知的次数
+    rec.add_socket(serv.get_fd(), net::event::readable, net::pattern::et, [&](int) {
+        int fd = 0;
+        while ((fd = serv.accept_req()) > 0) {
+            net::set_nonblocking(fd);
+            rec.add_connection(fd, [&](net::connection* conn) {
+                auto* in = conn->input();
+                for (; in->readable_bytes(); in->retrieve(1)) {
+                    if (*in->peek() == 's') {  // 小于阈值，复制发送并立即释放
+                        rec.send_zerocopy(conn, "ok", 2, [&small_released] { ++small_released; });
+                        assert(small_released == 1);
+                    } else {
+                        ++sent;
+                        rec.send_zerocopy(conn, data.get(), block, [&released] { ++released; });
+                        inflight += conn->zerocopy_inflight() > 0;
+                    }
+                }
+            });
+        }
+    });
+
+    size_t received = 0;
+    std::thread client([&] {
+        net::tcp_clnt_socket clnt;
+        clnt.launch_req("127.0.0.1", port);
+        char buf[4096];
+        ssize_t bytes = 0;
+        assert(write(clnt.get_fd(), "s", 1) == 1);
+        while (received < 2 && (bytes = read(clnt.get_fd(), buf, 2 - received)) > 0) {
+            received += bytes;
+        }
+        received = 0;
+        std::unique_ptr<char[]> back(new char[block]);
+        for (int i = 0; i < requests; ++i) {
+            assert(write(clnt.get_fd(), "z", 1) == 1);
+            size_t got = 0;
+            while (got < block && (bytes = read(clnt.get_fd(), back.get() + got, block - got)) > 0) {
+                got += bytes;
+            }
+            assert(got == block && !memcmp(back.get(), data.get(), block));
+            received += got;
+        }
+        rec.post([&rec] { rec.run_after(50, [&rec] { rec.destroy(); }); });
+    });
+    rec.activate();
+    client.join();
+    std::cout << "received: " << received << " sent: " << sent << " released: " << released
+              << " inflight: " << inflight << std::endl;
+    assert(received == block * requests);
+    assert(sent == requests && released == requests);  // 客户端关闭后未完成的缓冲区同样被释放
+    assert(inflight > 0);
+}
+
+int main() {
+    test_zerocopy(net::backend::epoll);
+    test_zerocopy(net::backend::uring);
+}